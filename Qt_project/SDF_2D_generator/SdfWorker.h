@@ -1,6 +1,8 @@
 #ifndef SDFWORKER_H
 #define SDFWORKER_H
 
+#include "SdfGenerator.h"
+
 #include <QImage>
 #include <QObject>
 #include <QString>
@@ -12,7 +14,7 @@ class SdfWorker : public QObject
     Q_OBJECT
 
 public:
-    SdfWorker(const QImage &input, int outW, int outH, int threshold, int maxDist);
+    SdfWorker(const QImage &input, const sdf::SdfOptions &options);
 
     void requestCancel();
 
@@ -27,10 +29,7 @@ signals:
 
 private:
     QImage inputImage;
-    int outWidth;
-    int outHeight;
-    int thresholdValue;
-    int maxDistance;
+    sdf::SdfOptions options;
     std::atomic_bool cancelRequested;
 };
 
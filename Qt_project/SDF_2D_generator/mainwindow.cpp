@@ -108,10 +108,15 @@ void MainWindow::onGenerateClicked()
         return;
     }
 
-    const int outW = ui->outputWidthSpin->value();
-    const int outH = ui->outputHeightSpin->value();
-    const int threshold = ui->thresholdSpin->value();
-    const int maxDist = ui->maxDistanceSpin->value();
+    sdf::SdfOptions options;
+    options.outWidth = ui->outputWidthSpin->value();
+    options.outHeight = ui->outputHeightSpin->value();
+    options.threshold = ui->thresholdSpin->value();
+    options.maxDistance = ui->maxDistanceSpin->value();
+    options.antiAliased = ui->antiAliasedCheck->isChecked();
+    options.normalization = ui->fixedRangeCheck->isChecked() ? sdf::Normalization::FixedRange
+                                                             : sdf::Normalization::MinMax;
+    options.draftScale = ui->draftCheck->isChecked() ? 4 : 1;
 
     ui->generateButton->setEnabled(false);
     ui->cancelButton->setEnabled(true);
@@ -119,7 +124,7 @@ void MainWindow::onGenerateClicked()
     ui->progressBar->setValue(0);
 
     workerThread = new QThread(this);
-    worker = new SdfWorker(originalImage, outW, outH, threshold, maxDist);
+    worker = new SdfWorker(originalImage, options);
     worker->moveToThread(workerThread);
 
     connect(workerThread, &QThread::started, worker, &SdfWorker::process);
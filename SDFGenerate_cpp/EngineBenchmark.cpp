@@ -0,0 +1,625 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "lodepng.h"
+#include "BitMask.h"
+#include "Contour.h"
+#include "DistanceTransform.h"
+#include "MappedBuffer.h"
+#include "Meijster.h"
+#include "RunMask.h"
+#include "SdfGenerator.h"
+#include "TiledSdf.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+/* Compares the exact engines on every PNG given on the command line
+   (default: the sample images). Each image is thresholded at its own size
+   and both fields (distance to outside and to inside) are computed. The
+   narrow band and coarse to fine modes must match the full transform byte
+   for byte with either normalization, and generateSdf() from a run-length
+   mask must match the gray-image path at other output sizes in every
+   precision and engine. The tiled streaming generator is checked against
+   generateSdf() with the same fixed spread, and the contour path against
+   generateSdf() of the image padded with outside pixels, which is how the
+   contour treats the border, within CONTOUR_TOLERANCE codes.
+   updateSdfRect() after an edit must match a full run byte for byte. A
+   synthetic strip wider than the uint32 squared-distance range checks that
+   the default precision matches Precision::Double, and a synthetic image of
+   more than 2^31 pixels is streamed through the tiled generator, checking
+   the pixel count, probe codes and 64-bit row addressing. */
+
+#define PNG_TRESHOLD 127
+#define RUNS 5
+#define TILE_SIZE 256
+#define TILE_MAX_DISTANCE 32
+#define COARSE_LARGE_BAND 96
+#define COARSE_SMALL_BAND 12
+#define WIDE_STRIP_WIDTH 100000
+/* 2,151,680,000 pixels, past 2^31, streamed through generateSdfTiled() */
+#define GIGA_WIDTH 65600
+#define GIGA_HEIGHT 32800
+#define GIGA_MAX_DISTANCE 8
+#define GIGA_TILE_SIZE 1024
+#define GIGA_CELL_WIDTH 777
+#define GIGA_CELL_HEIGHT 555
+#define GIGA_RADIUS 5000
+/* half size of the generateSdf() windows the probes are checked against;
+   beyond GIGA_MAX_DISTANCE the crop cannot change a clamped code */
+#define GIGA_PROBE_REACH 16
+/* 2 codes = 0.5 px at TILE_MAX_DISTANCE: the contour places slanted edges
+   exactly, the raster only between pixel centres */
+#define CONTOUR_TOLERANCE 2
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsed_ms(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+template <typename T>
+static double time_felzenszwalb(const sdf::BitMask &mask, std::vector<T> *last)
+{
+	double best = 1e30;
+	int run;
+
+	for (run = 0; run < RUNS; run++) {
+		Clock::time_point start = Clock::now();
+		std::vector<T> outside = sdf::distanceTransform2D<T>(mask, false, NULL, NULL);
+		std::vector<T> inside = sdf::distanceTransform2D<T>(mask, true, NULL, NULL);
+		best = std::min(best, elapsed_ms(start));
+		*last = outside;
+		last->insert(last->end(), inside.begin(), inside.end());
+	}
+	return best;
+}
+
+static double time_meijster(const sdf::BitMask &mask, std::vector<sdf::SquaredDistance> *last)
+{
+	double best = 1e30;
+	int run;
+
+	for (run = 0; run < RUNS; run++) {
+		Clock::time_point start = Clock::now();
+		std::vector<sdf::SquaredDistance> outside = sdf::meijsterDistanceTransform(mask, false, NULL, NULL);
+		std::vector<sdf::SquaredDistance> inside = sdf::meijsterDistanceTransform(mask, true, NULL, NULL);
+		best = std::min(best, elapsed_ms(start));
+		*last = outside;
+		last->insert(last->end(), inside.begin(), inside.end());
+	}
+	return best;
+}
+
+/* Streams the red channel of the RGBA image through generateSdfTiled() and
+   stores the tiles in last. */
+static double time_tiled(const unsigned char *rgba, int width, int height, std::vector<unsigned char> *last)
+{
+	double best = 1e30;
+	int run;
+	sdf::TiledSdfOptions options;
+
+	options.width = width;
+	options.height = height;
+	options.threshold = PNG_TRESHOLD;
+	options.maxDistance = TILE_MAX_DISTANCE;
+	options.tileSize = TILE_SIZE;
+	last->assign((size_t)width * height, 0);
+
+	sdf::SourceRowFn source_row = [&](int y, unsigned char *row) {
+		const unsigned char *pixel = rgba + (size_t)y * width * 4;
+		int x;
+		for (x = 0; x < width; x++) {
+			row[x] = pixel[x * 4];
+		}
+		return true;
+	};
+	sdf::TileSinkFn sink = [&](int x0, int y0, const sdf::GrayImageView &tile) {
+		int y;
+		for (y = 0; y < tile.height; y++) {
+			memcpy(last->data() + (size_t)(y0 + y) * width + x0, tile.row(y), tile.width);
+		}
+	};
+
+	for (run = 0; run < RUNS; run++) {
+		Clock::time_point start = Clock::now();
+		sdf::generateSdfTiled(options, source_row, sink, NULL, NULL);
+		best = std::min(best, elapsed_ms(start));
+	}
+	return best;
+}
+
+static void fill_fixed_range(sdf::SdfOptions *options, int width, int height)
+{
+	options->outWidth = width;
+	options->outHeight = height;
+	options->threshold = PNG_TRESHOLD;
+	options->maxDistance = TILE_MAX_DISTANCE;
+	options->normalization = sdf::Normalization::FixedRange;
+}
+
+static sdf::GrayImageView gray_view(const std::vector<unsigned char> &gray, int width, int height)
+{
+	sdf::GrayImageView view;
+
+	view.data = gray.data();
+	view.width = width;
+	view.height = height;
+	view.stride = width;
+	return view;
+}
+
+static sdf::OutputImageView output_view(std::vector<unsigned char> *pixels, int width, int height)
+{
+	sdf::OutputImageView view;
+
+	view.data = pixels->data();
+	view.width = width;
+	view.height = height;
+	view.stride = width;
+	return view;
+}
+
+static std::vector<unsigned char> red_channel(const unsigned char *rgba, int width, int height)
+{
+	std::vector<unsigned char> gray((size_t)width * height);
+	size_t i;
+
+	for (i = 0; i < gray.size(); i++) {
+		gray[i] = rgba[i * 4];
+	}
+	return gray;
+}
+
+/* generateSdf() of a width x height gray image at the options' output
+   size. */
+static std::vector<unsigned char> gray_sdf(const std::vector<unsigned char> &gray, int width, int height,
+	const sdf::SdfOptions &options)
+{
+	std::vector<unsigned char> result((size_t)options.outWidth * options.outHeight, 0);
+
+	sdf::generateSdf(gray_view(gray, width, height), options,
+		output_view(&result, options.outWidth, options.outHeight), NULL, NULL);
+	return result;
+}
+
+/* generateSdf() of a gray image at its own size with the fixed spread
+   time_tiled() uses. */
+static std::vector<unsigned char> fixed_range_sdf(const std::vector<unsigned char> &gray, int width, int height)
+{
+	sdf::SdfOptions options;
+
+	fill_fixed_range(&options, width, height);
+	return gray_sdf(gray, width, height, options);
+}
+
+/* The narrow band mode, or coarse to fine with coarse_to_fine, against the
+   full transform clamped at band, with both normalizations. */
+static bool band_matches(const std::vector<unsigned char> &gray, int width, int height, bool coarse_to_fine, int band)
+{
+	static const sdf::Normalization normalizations[] = { sdf::Normalization::MinMax,
+		sdf::Normalization::FixedRange };
+	size_t n;
+
+	for (n = 0; n < sizeof(normalizations) / sizeof(normalizations[0]); n++) {
+		sdf::SdfOptions options;
+		fill_fixed_range(&options, width, height);
+		options.maxDistance = band;
+		options.normalization = normalizations[n];
+		std::vector<unsigned char> full = gray_sdf(gray, width, height, options);
+		options.narrowBand = !coarse_to_fine;
+		options.coarseToFine = coarse_to_fine;
+		if (gray_sdf(gray, width, height, options) != full) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* generateSdf() from runMaskFromImage() against the gray-image path, for
+   every precision and for Meijster's engine, at output sizes that shrink
+   one axis and stretch the other so that resampleRunMask() has to map the
+   toggle columns. */
+static bool run_mask_matches(const std::vector<unsigned char> &gray, int width, int height)
+{
+	static const sdf::Precision precisions[] = { sdf::Precision::Auto, sdf::Precision::Float,
+		sdf::Precision::Double, sdf::Precision::Exact };
+	const int precision_count = (int)(sizeof(precisions) / sizeof(precisions[0]));
+	const int sizes[2][2] = { { width * 3 / 5 + 1, height * 7 / 5 }, { width * 5 / 3, height * 2 / 3 + 1 } };
+	sdf::RunMask runs = sdf::runMaskFromImage(gray_view(gray, width, height), 1, 0, PNG_TRESHOLD);
+	int n, p;
+
+	for (n = 0; n < 2; n++) {
+		/* p == precision_count: Meijster */
+		for (p = 0; p <= precision_count; p++) {
+			sdf::SdfOptions options;
+			options.outWidth = sizes[n][0];
+			options.outHeight = sizes[n][1];
+			options.threshold = PNG_TRESHOLD;
+			if (p < precision_count) {
+				options.precision = precisions[p];
+			} else {
+				options.engine = sdf::Engine::Meijster;
+			}
+			std::vector<unsigned char> result((size_t)options.outWidth * options.outHeight, 0);
+			if (sdf::generateSdf(runs, options, output_view(&result, options.outWidth, options.outHeight), NULL,
+					NULL) != sdf::Status::Ok
+				|| result != gray_sdf(gray, width, height, options)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/* fixed_range_sdf() of the red channel. With pad > 0 the channel is
+   surrounded by pad outside pixels first and the result is cropped back to
+   the source size. */
+static std::vector<unsigned char> whole_image_sdf(const unsigned char *rgba, int width, int height, int pad)
+{
+	const int padded_width = width + 2 * pad;
+	const int padded_height = height + 2 * pad;
+	std::vector<unsigned char> gray((size_t)padded_width * padded_height, 0);
+	std::vector<unsigned char> result((size_t)width * height, 0);
+	int x, y;
+
+	for (y = 0; y < height; y++) {
+		for (x = 0; x < width; x++) {
+			gray[(size_t)(y + pad) * padded_width + x + pad] = rgba[((size_t)y * width + x) * 4];
+		}
+	}
+	std::vector<unsigned char> padded = fixed_range_sdf(gray, padded_width, padded_height);
+	for (y = 0; y < height; y++) {
+		memcpy(result.data() + (size_t)y * width, padded.data() + (size_t)(y + pad) * padded_width + pad, width);
+	}
+	return result;
+}
+
+/* Inverts a rectangle in the middle of the red channel, patches the
+   unedited field with updateSdfRect() and checks it byte for byte against
+   a full run on the edited image. */
+static bool update_matches(const unsigned char *rgba, int width, int height)
+{
+	std::vector<unsigned char> gray((size_t)width * height);
+	sdf::SdfOptions options;
+	sdf::SdfRect dirty;
+	size_t i;
+	int x, y;
+
+	for (i = 0; i < gray.size(); i++) {
+		gray[i] = rgba[i * 4];
+	}
+	std::vector<unsigned char> patched = fixed_range_sdf(gray, width, height);
+
+	dirty.x0 = width / 4;
+	dirty.y0 = height / 3;
+	dirty.x1 = dirty.x0 + width / 3;
+	dirty.y1 = dirty.y0 + height / 4;
+	for (y = dirty.y0; y < dirty.y1; y++) {
+		for (x = dirty.x0; x < dirty.x1; x++) {
+			gray[(size_t)y * width + x] = 255 - gray[(size_t)y * width + x];
+		}
+	}
+	fill_fixed_range(&options, width, height);
+	if (sdf::updateSdfRect(gray_view(gray, width, height), options, dirty, output_view(&patched, width, height),
+			NULL, NULL) != sdf::Status::Ok) {
+		return false;
+	}
+	return patched == fixed_range_sdf(gray, width, height);
+}
+
+/* Extracts the contour of the red channel once and times
+   generateSdfFromContour() at the source size with the same fixed spread. */
+static double time_contour(const unsigned char *rgba, int width, int height, std::vector<unsigned char> *last)
+{
+	double best = 1e30;
+	int run;
+	std::vector<unsigned char> gray((size_t)width * height);
+	sdf::SdfOptions options;
+	size_t i;
+
+	for (i = 0; i < gray.size(); i++) {
+		gray[i] = rgba[i * 4];
+	}
+	sdf::Contour contour = sdf::Contour::extract(gray_view(gray, width, height), PNG_TRESHOLD, NULL);
+
+	last->assign((size_t)width * height, 0);
+	fill_fixed_range(&options, width, height);
+	for (run = 0; run < RUNS; run++) {
+		Clock::time_point start = Clock::now();
+		sdf::generateSdfFromContour(contour, options, output_view(last, width, height), NULL, NULL);
+		best = std::min(best, elapsed_ms(start));
+	}
+	return best;
+}
+
+/* Largest byte difference between two images of the same size. */
+static int max_difference(const std::vector<unsigned char> &a, const std::vector<unsigned char> &b)
+{
+	int worst = 0;
+	size_t i;
+
+	for (i = 0; i < a.size(); i++) {
+		worst = std::max(worst, abs((int)a[i] - (int)b[i]));
+	}
+	return worst;
+}
+
+/* generateSdf() of a WIDE_STRIP_WIDTH x 2 strip with a few inside runs,
+   unclamped, so squared distances pass the uint32 range. */
+static std::vector<unsigned char> wide_strip_sdf(sdf::Precision precision)
+{
+	const int width = WIDE_STRIP_WIDTH;
+	const int height = 2;
+	std::vector<unsigned char> gray((size_t)width * height, 0);
+	std::vector<unsigned char> result((size_t)width * height, 0);
+	sdf::GrayImageView source;
+	sdf::OutputImageView target;
+	sdf::SdfOptions options;
+	int x;
+
+	for (x = 0; x < 40; x++) {
+		gray[x] = 255;
+		gray[(size_t)width + 51234 + x] = 255;
+		gray[width - 1 - x] = 255;
+	}
+	source.data = gray.data();
+	source.width = width;
+	source.height = height;
+	source.stride = width;
+	target.data = result.data();
+	target.width = width;
+	target.height = height;
+	target.stride = width;
+	options.outWidth = width;
+	options.outHeight = height;
+	options.threshold = PNG_TRESHOLD;
+	options.precision = precision;
+	sdf::generateSdf(source, options, target, NULL, NULL);
+	return result;
+}
+
+/* Row y of the gigapixel test image: a checkerboard of
+   GIGA_CELL_WIDTH x GIGA_CELL_HEIGHT cells, inverted inside a circle of
+   GIGA_RADIUS around the centre. */
+static void giga_row(int y, unsigned char *row)
+{
+	const double dy = y + 0.5 - GIGA_HEIGHT / 2;
+	int x, x0;
+
+	for (x0 = 0; x0 < GIGA_WIDTH; x0 += GIGA_CELL_WIDTH) {
+		const int inside = (x0 / GIGA_CELL_WIDTH + y / GIGA_CELL_HEIGHT) & 1;
+		memset(row + x0, inside ? 255 : 0, std::min(GIGA_CELL_WIDTH, GIGA_WIDTH - x0));
+	}
+	if (fabs(dy) < GIGA_RADIUS) {
+		const double half = sqrt((double)GIGA_RADIUS * GIGA_RADIUS - dy * dy);
+		const int start = std::max(0, (int)ceil(GIGA_WIDTH / 2 - half - 0.5));
+		const int end = std::min(GIGA_WIDTH, (int)floor(GIGA_WIDTH / 2 + half - 0.5) + 1);
+		for (x = start; x < end; x++) {
+			row[x] = 255 - row[x];
+		}
+	}
+}
+
+/* FixedRange generateSdf() of the GIGA_PROBE_REACH window around (px, py),
+   at the pixel itself. */
+static int giga_probe_reference(int px, int py)
+{
+	const int x0 = std::max(0, px - GIGA_PROBE_REACH);
+	const int y0 = std::max(0, py - GIGA_PROBE_REACH);
+	const int x1 = std::min(GIGA_WIDTH, px + GIGA_PROBE_REACH + 1);
+	const int y1 = std::min(GIGA_HEIGHT, py + GIGA_PROBE_REACH + 1);
+	const int width = x1 - x0;
+	const int height = y1 - y0;
+	std::vector<unsigned char> line(GIGA_WIDTH);
+	std::vector<unsigned char> gray((size_t)width * height);
+	std::vector<unsigned char> result((size_t)width * height);
+	sdf::SdfOptions options;
+	int y;
+
+	for (y = y0; y < y1; y++) {
+		giga_row(y, line.data());
+		memcpy(gray.data() + (size_t)(y - y0) * width, line.data() + x0, width);
+	}
+	options.outWidth = width;
+	options.outHeight = height;
+	options.threshold = PNG_TRESHOLD;
+	options.maxDistance = GIGA_MAX_DISTANCE;
+	options.normalization = sdf::Normalization::FixedRange;
+	sdf::generateSdf(gray_view(gray, width, height), options, output_view(&result, width, height), NULL, NULL);
+	return result[(size_t)(py - y0) * width + (px - x0)];
+}
+
+/* Streams the gigapixel image through generateSdfTiled() without keeping
+   the output: the sink counts the pixels it receives and picks up the
+   probes, which must match generateSdf() on a window around each. */
+static bool giga_tiled_matches(double *ms)
+{
+	static const int probes[][2] = {
+		{ 0, 0 }, { GIGA_WIDTH - 1, 0 }, { 0, GIGA_HEIGHT - 1 }, { GIGA_WIDTH - 1, GIGA_HEIGHT - 1 },
+		{ GIGA_CELL_WIDTH - 3, GIGA_CELL_HEIGHT * 7 + 100 }, { GIGA_CELL_WIDTH * 60 + 1, GIGA_CELL_HEIGHT * 50 - 2 },
+		{ GIGA_WIDTH / 2 + GIGA_RADIUS - 2, GIGA_HEIGHT / 2 + 3 }, { GIGA_WIDTH / 2 + 3000, GIGA_HEIGHT / 2 - 4001 },
+		{ GIGA_WIDTH / 2, GIGA_HEIGHT / 2 }, { GIGA_WIDTH - 5, GIGA_HEIGHT / 2 },
+	};
+	const int probe_count = (int)(sizeof(probes) / sizeof(probes[0]));
+	int codes[sizeof(probes) / sizeof(probes[0])];
+	unsigned long long pixels = 0;
+	sdf::TiledSdfOptions options;
+	int n;
+
+	options.width = GIGA_WIDTH;
+	options.height = GIGA_HEIGHT;
+	options.threshold = PNG_TRESHOLD;
+	options.maxDistance = GIGA_MAX_DISTANCE;
+	options.tileSize = GIGA_TILE_SIZE;
+	for (n = 0; n < probe_count; n++) {
+		codes[n] = -1;
+	}
+
+	sdf::SourceRowFn source_row = [](int y, unsigned char *row) {
+		giga_row(y, row);
+		return true;
+	};
+	sdf::TileSinkFn sink = [&](int x0, int y0, const sdf::GrayImageView &tile) {
+		int i;
+		pixels += (unsigned long long)tile.width * tile.height;
+		for (i = 0; i < probe_count; i++) {
+			const int x = probes[i][0] - x0;
+			const int y = probes[i][1] - y0;
+			if (x >= 0 && x < tile.width && y >= 0 && y < tile.height) {
+				codes[i] = tile.row(y)[x];
+			}
+		}
+	};
+
+	Clock::time_point start = Clock::now();
+	sdf::Status status = sdf::generateSdfTiled(options, source_row, sink, NULL, NULL);
+	*ms = elapsed_ms(start);
+	if (status != sdf::Status::Ok || pixels != (unsigned long long)GIGA_WIDTH * GIGA_HEIGHT) {
+		printf("  status %d, %llu pixels", (int)status, pixels);
+		return false;
+	}
+	for (n = 0; n < probe_count; n++) {
+		const int expected = giga_probe_reference(probes[n][0], probes[n][1]);
+		if (codes[n] != expected) {
+			printf("  probe (%d, %d) %d, expected %d", probes[n][0], probes[n][1], codes[n], expected);
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Row addressing past 2^31: the last row of a GIGA_WIDTH x GIGA_HEIGHT
+   gray view starts y * stride bytes in, and the last row of a BitMask of
+   the same size y * wordsPerRow * 64 bits in. The gray buffer is left
+   uninitialized, so only the pages written here are touched. */
+static bool giga_rows_match(void)
+{
+	const int last = GIGA_HEIGHT - 1;
+	sdf::MappedBuffer buffer((size_t)GIGA_WIDTH * GIGA_HEIGHT);
+	sdf::GrayImageView view;
+	unsigned char *bytes = buffer.data<unsigned char>();
+
+	bytes[0] = 1;
+	bytes[(size_t)last * GIGA_WIDTH + GIGA_WIDTH - 1] = 2;
+	view.data = bytes;
+	view.width = GIGA_WIDTH;
+	view.height = GIGA_HEIGHT;
+	view.stride = GIGA_WIDTH;
+	if (view.row(0)[0] != 1 || view.row(last)[GIGA_WIDTH - 1] != 2) {
+		return false;
+	}
+
+	sdf::BitMask mask(GIGA_WIDTH, GIGA_HEIGHT);
+	mask.row(last)[mask.wordsPerRow() - 1] |= (sdf::BitMask::Word)1 << ((GIGA_WIDTH - 1) % sdf::BitMask::kWordBits);
+	return mask.get(GIGA_WIDTH - 1, last) && !mask.get(GIGA_WIDTH - 2, last) && !mask.get(GIGA_WIDTH - 1, last - 1)
+		&& (size_t)(mask.row(last) - mask.row(0)) == (size_t)last * mask.wordsPerRow();
+}
+
+int main(int argc, char **argv)
+{
+	static const char *default_corpus[] = { "source.png", "source600.png" };
+	const char **corpus = argc > 1 ? (const char **)(argv + 1) : default_corpus;
+	int count = argc > 1 ? argc - 1 : 2;
+	int n, failures = 0;
+
+	printf("%-24s %11s %10s %10s %10s %10s %10s\n", "image", "size", "fh-float", "fh-exact", "meijster", "tiled",
+		"contour");
+	for (n = 0; n < count; n++) {
+		unsigned char *rgba;
+		unsigned width, height, error;
+		sdf::GrayImageView view;
+
+		error = lodepng_decode32_file(&rgba, &width, &height, corpus[n]);
+		if (error) {
+			printf("%-24s error %u: %s\n", corpus[n], error, lodepng_error_text(error));
+			failures++;
+			continue;
+		}
+
+		/* red channel of the RGBA rows, packed one bit per pixel */
+		view.data = rgba;
+		view.width = (int)width;
+		view.height = (int)height;
+		view.stride = (std::ptrdiff_t)width * 4;
+		sdf::BitMask mask = sdf::thresholdImage(view, 4, 0, PNG_TRESHOLD);
+
+		std::vector<float> float_result;
+		std::vector<sdf::SquaredDistance> exact_result, meijster_result;
+		double float_ms = time_felzenszwalb<float>(mask, &float_result);
+		double exact_ms = time_felzenszwalb<sdf::SquaredDistance>(mask, &exact_result);
+		double meijster_ms = time_meijster(mask, &meijster_result);
+		std::vector<unsigned char> tiled_result;
+		double tiled_ms = time_tiled(rgba, (int)width, (int)height, &tiled_result);
+		bool tiled_match = tiled_result == whole_image_sdf(rgba, (int)width, (int)height, 0);
+		std::vector<unsigned char> contour_result;
+		double contour_ms = time_contour(rgba, (int)width, (int)height, &contour_result);
+		int contour_difference =
+			max_difference(contour_result, whole_image_sdf(rgba, (int)width, (int)height, TILE_MAX_DISTANCE + 1));
+		bool update_match = update_matches(rgba, (int)width, (int)height);
+		std::vector<unsigned char> gray = red_channel(rgba, (int)width, (int)height);
+		bool narrow_band_match = band_matches(gray, (int)width, (int)height, false, TILE_MAX_DISTANCE);
+		/* one band with coarse cell windows, one under the 32-pixel cell
+		   size, where coarse to fine falls back to the narrow band */
+		bool coarse_match = band_matches(gray, (int)width, (int)height, true, COARSE_LARGE_BAND)
+			&& band_matches(gray, (int)width, (int)height, true, COARSE_SMALL_BAND);
+		bool run_mask_match = run_mask_matches(gray, (int)width, (int)height);
+		free(rgba);
+
+		char size[32];
+		snprintf(size, sizeof(size), "%ux%u", width, height);
+		printf("%-24s %11s %8.2fms %8.2fms %8.2fms %8.2fms %8.2fms", corpus[n], size, float_ms, exact_ms,
+			meijster_ms, tiled_ms, contour_ms);
+		if (meijster_result != exact_result) {
+			printf("  MISMATCH");
+			failures++;
+		}
+		if (!coarse_match) {
+			printf("  COARSE TO FINE MISMATCH");
+			failures++;
+		}
+		if (!narrow_band_match) {
+			printf("  NARROW BAND MISMATCH");
+			failures++;
+		}
+		if (!run_mask_match) {
+			printf("  RUN MASK MISMATCH");
+			failures++;
+		}
+		if (!tiled_match) {
+			printf("  TILED MISMATCH");
+			failures++;
+		}
+		if (contour_difference > CONTOUR_TOLERANCE) {
+			printf("  CONTOUR OFF BY %d", contour_difference);
+			failures++;
+		}
+		if (!update_match) {
+			printf("  UPDATE MISMATCH");
+			failures++;
+		}
+		printf("\n");
+	}
+
+	Clock::time_point start = Clock::now();
+	bool wide_match = wide_strip_sdf(sdf::Precision::Auto) == wide_strip_sdf(sdf::Precision::Double);
+	printf("%-24s %11s %8.2fms", "wide strip auto/double", "100000x2", elapsed_ms(start));
+	if (!wide_match) {
+		printf("  MISMATCH");
+		failures++;
+	}
+	printf("\n");
+
+	double giga_ms = 0;
+	bool giga_match = giga_rows_match() && giga_tiled_matches(&giga_ms);
+	printf("%-24s %11s %8.2fms", "gigapixel tiled", "65600x32800", giga_ms);
+	if (!giga_match) {
+		printf("  MISMATCH");
+		failures++;
+	}
+	printf("\n");
+	return failures ? 1 : 0;
+}
@@ -1,8 +1,13 @@
 #define _CRT_SECURE_NO_DEPRECATE
 #include <stdlib.h>
 #include <stdio.h>
-#include <math.h>
 #include "lodepng.h"
+#include "MappedBuffer.h"
+#include "RunMask.h"
+#include "ScratchArena.h"
+#include "SdfGenerator.h"
+
+#include <vector>
 
 #define INPUT_NAME "source600.png"
 
@@ -12,93 +17,44 @@
 
 #define MAX_DISTANCE 512
 #define PNG_TRESHOLD 127
+/* 1 = only transform tiles within MAX_DISTANCE of the boundary (same output) */
+#define NARROW_BAND 0
+/* 1 = narrow band with the far tiles found on a coarse 32 x 32 cell level (same output) */
+#define COARSE_TO_FINE 0
+/* 1 = sub-pixel edges from the gray levels around the threshold (EDTAA3) */
+#define ANTI_ALIASED 0
+/* 1 = Meijster's linear-time transform instead of Felzenszwalb's (same output) */
+#define MEIJSTER 0
+/* 1 = map distances as 0.5 + d / (2 * MAX_DISTANCE) instead of the image's min..max */
+#define FIXED_RANGE 0
+/* > 0: intermediates of at least this many MB go to mapped scratch files in
+   SCRATCH_DIR ("" = $TMPDIR or /tmp) instead of the heap */
+#define MAPPED_SCRATCH_MB 0
+#define SCRATCH_DIR ""
+/* 1 = threshold the decoded rows straight into a run-length mask instead of
+   a gray copy of the image (same output) */
+#define RUN_LENGTH_MASK 0
+/* 2 or 4 = draft: compute at 1/DRAFT_SCALE of the output size and upsample;
+   the error against the full-resolution field is printed */
+#define DRAFT_SCALE 1
 
 unsigned char output[2 + OUTPUT_WIDTH * OUTPUT_HEIGHT];
-double buffer[OUTPUT_WIDTH * OUTPUT_HEIGHT];
 
 unsigned char *input;
 unsigned input_width, input_height;
-double max_distance = -MAX_DISTANCE;
-double min_distance = MAX_DISTANCE;
+int total_progress_units;
 
-void set_pixel(int x, int y)
+static void print_progress(int delta)
 {
-	int source_is_inside, target_is_inside, cx, cy, ix, iy, dx, dy, im;
-	int minx, miny, maxx, maxy;
-	double min, distance;
-
-	cx = (x * input_width) / OUTPUT_WIDTH;
-	cy = (y * input_height) / OUTPUT_HEIGHT;
-
-	min = MAX_DISTANCE;
-
-	minx = cx - MAX_DISTANCE;
-	if (minx < 0) {
-		minx = 0;
-	}
-	miny = cy - MAX_DISTANCE;
-	if (miny < 0) {
-		miny = 0;
-	}
-	maxx = cx + MAX_DISTANCE;
-	if (maxx > (int)input_width) {
-		maxx = input_width;
-	}
-	maxy = cy + MAX_DISTANCE;
-	if (maxy > (int)input_height) {
-		maxy = input_height;
-	}
-
-	source_is_inside = input[(cx + cy * input_width) << 2] > PNG_TRESHOLD;
-	if (source_is_inside) {
-		for (iy = miny; iy < maxy; iy++) {
-			dy = iy - cy;
-			dy *= dy;
-			im = iy * input_width;
-			for (ix = minx; ix < maxx; ix++) {
-				target_is_inside = input[(ix + im) << 2] > PNG_TRESHOLD;
-				if (target_is_inside) {
-					continue;
-				}
-				dx = ix - cx;
-				distance = sqrt(dx * dx + dy);
-				if (distance < min) {
-					min = distance;
-				}
-			}
-		}
-
-		if (min > max_distance) {
-			max_distance = min;
-		}
-
-		buffer[x + y * OUTPUT_WIDTH] = min;
-		// printf(" ");
-	}
-	else {
-		for (iy = miny; iy < maxy; iy++) {
-			dy = iy - cy;
-			dy *= dy;
-			im = iy * input_width;
-			for (ix = minx; ix < maxx; ix++) {
-				target_is_inside = input[(ix + im) << 2] > PNG_TRESHOLD;
-				if (!target_is_inside) {
-					continue;
-				}
-				dx = ix - cx;
-				distance = sqrt(dx * dx + dy);
-				if (distance < min) {
-					min = distance;
-				}
-			}
-		}
-
-		if (-min < min_distance) {
-			min_distance = -min;
-		}
-
-		buffer[x + y * OUTPUT_WIDTH] = -min;
-		// printf(".");
+	static int done = 0;
+	static int last_pct = -1;
+	int pct;
+
+	done += delta;
+	pct = (done * 100) / total_progress_units;
+	if (pct != last_pct) {
+		printf("%d%%\n", pct);
+		last_pct = pct;
 	}
 }
 
@@ -108,11 +64,10 @@ int main(int argc, char** argv)
 	printf("current output resolution: %d * %d\n", OUTPUT_HEIGHT, OUTPUT_WIDTH);
 	unsigned char *debug_png;
 	FILE *file;
-	int i, pixels, ox, oy;
-	double raw_pixel;
-	size_t png_i;
+	int i;
+	size_t p, pixels, png_i;
 	unsigned error;
-	char pixel;
+	unsigned char pixel;
 
 	output[0] = OUTPUT_WIDTH;
 	output[1] = OUTPUT_HEIGHT;
@@ -124,27 +79,93 @@ int main(int argc, char** argv)
 		exit(1);
 	}
 
-	/* Ugly bruteforce */
-#pragma omp for
-	for (oy = 0; oy < OUTPUT_HEIGHT; oy++) {
-		for (ox = 0; ox < OUTPUT_WIDTH; ox++) {
-			set_pixel(ox, oy);
+	/* Threshold the red channel, like the original brute force did */
+	pixels = (size_t)input_width * input_height;
+	std::vector<unsigned char> gray;
+	sdf::RunMask runs;
+	sdf::GrayImageView source;
+	if (RUN_LENGTH_MASK) {
+		sdf::GrayImageView rgba;
+		rgba.data = input;
+		rgba.width = (int)input_width;
+		rgba.height = (int)input_height;
+		rgba.stride = (std::ptrdiff_t)input_width * 4;
+		runs = sdf::runMaskFromImage(rgba, 4, 0, PNG_TRESHOLD);
+		printf("run-length mask: %llu edges\n", (unsigned long long)runs.edgeCount());
+	} else {
+		gray.resize(pixels);
+		for (p = 0; p < pixels; p++) {
+			gray[p] = input[p << 2];
 		}
-		printf("%d\n", oy);
+		source.data = gray.data();
+		source.width = (int)input_width;
+		source.height = (int)input_height;
+		source.stride = (int)input_width;
+	}
+
+	sdf::SdfOptions options;
+	options.outWidth = OUTPUT_WIDTH;
+	options.outHeight = OUTPUT_HEIGHT;
+	options.threshold = PNG_TRESHOLD;
+	options.maxDistance = MAX_DISTANCE;
+	options.narrowBand = NARROW_BAND != 0;
+	options.coarseToFine = COARSE_TO_FINE != 0;
+	options.antiAliased = ANTI_ALIASED != 0;
+	options.engine = MEIJSTER ? sdf::Engine::Meijster : sdf::Engine::Felzenszwalb;
+	options.normalization = FIXED_RANGE ? sdf::Normalization::FixedRange : sdf::Normalization::MinMax;
+	options.draftScale = DRAFT_SCALE;
+	total_progress_units = sdf::progressUnits(options);
+
+	sdf::MappedScratchConfig scratch;
+	scratch.directory = SCRATCH_DIR;
+	scratch.minBytes = (size_t)MAPPED_SCRATCH_MB << 20;
+	sdf::setMappedScratchConfig(scratch);
+
+	sdf::OutputImageView target;
+	target.data = output + 2;
+	target.width = OUTPUT_WIDTH;
+	target.height = OUTPUT_HEIGHT;
+	target.stride = OUTPUT_WIDTH;
+
+	sdf::Status status = RUN_LENGTH_MASK
+		? sdf::generateSdf(runs, options, target, nullptr, print_progress)
+		: sdf::generateSdf(source, options, target, nullptr, print_progress);
+	if (status != sdf::Status::Ok) {
+		fprintf(stderr, "SDF generation failed\n");
+		exit(1);
+	}
+	printf("scratch allocations: %llu\n", (unsigned long long)sdf::scratchAllocationCount());
+
+	sdf::SkipStats skips = sdf::skipStats();
+	printf("uniform rows: %llu / %llu, row samples skipped: %llu / %llu\n",
+		(unsigned long long)skips.rowPass.uniformLines, (unsigned long long)skips.rowPass.lines,
+		(unsigned long long)skips.rowPass.skippedSamples, (unsigned long long)skips.rowPass.samples);
+	printf("uniform columns: %llu / %llu, column samples skipped: %llu / %llu\n",
+		(unsigned long long)skips.columnPass.uniformLines, (unsigned long long)skips.columnPass.lines,
+		(unsigned long long)skips.columnPass.skippedSamples, (unsigned long long)skips.columnPass.samples);
+	printf("uniform tiles: %llu / %llu\n", (unsigned long long)skips.uniformTiles, (unsigned long long)skips.tiles);
+
+	sdf::ParallelStats stats = sdf::parallelStats();
+	printf("worker busy (ms):");
+	for (i = 0; i < (int)stats.busySeconds.size(); i++) {
+		printf(" %.1f", stats.busySeconds[i] * 1000.0);
 	}
+	printf(" / wall %.1f\n", stats.wallSeconds * 1000.0);
 
-	printf("%f %f\n", max_distance, min_distance);
+	if (DRAFT_SCALE > 1 && !RUN_LENGTH_MASK) {
+		sdf::DraftError draft;
+		if (sdf::measureDraftError(source, options, draft, nullptr) == sdf::Status::Ok) {
+			printf("draft error (px): max %.2f, mean %.3f, flipped pixels %lld\n",
+				draft.maxError, draft.meanError, (long long)draft.flippedPixels);
+		}
+	}
 
-	pixels = OUTPUT_WIDTH * OUTPUT_HEIGHT;
+	pixels = (size_t)OUTPUT_WIDTH * OUTPUT_HEIGHT;
 	debug_png = (unsigned char*)malloc(pixels * 4);
-	for (i = 0; i < pixels; i++) {
-		raw_pixel = buffer[i];
-		raw_pixel -= min_distance;
-		pixel = 255 - (raw_pixel / (max_distance - min_distance)) * 255;
-
-		output[i + 2] = pixel;
+	for (p = 0; p < pixels; p++) {
+		pixel = output[p + 2];
 
-		png_i = i << 2;
+		png_i = p << 2;
 		debug_png[png_i + 0] = pixel;
 		debug_png[png_i + 1] = pixel;
 		debug_png[png_i + 2] = pixel;
@@ -0,0 +1,327 @@
+#include "AntiAliased.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace sdf {
+
+namespace {
+
+// Source taps for every output sample along one axis.
+template <typename T>
+struct AxisWeights
+{
+    std::vector<int> offsets;
+    std::vector<int> taps;
+    std::vector<T> weights;
+};
+
+template <typename T>
+AxisWeights<T> axisWeights(int inSize, int outSize)
+{
+    AxisWeights<T> axis;
+    axis.offsets.reserve(static_cast<size_t>(outSize) + 1);
+    const double scale = static_cast<double>(inSize) / outSize;
+    for (int o = 0; o < outSize; ++o) {
+        axis.offsets.push_back(static_cast<int>(axis.taps.size()));
+        if (scale >= 1.0) {
+            const double begin = o * scale;
+            const double end = (o + 1) * scale;
+            const int first = static_cast<int>(std::floor(begin));
+            const int last = std::min(inSize, static_cast<int>(std::ceil(end)));
+            for (int s = first; s < last; ++s) {
+                const double overlap = std::min(end, s + 1.0) - std::max(begin, static_cast<double>(s));
+                if (overlap > 0.0) {
+                    axis.taps.push_back(s);
+                    axis.weights.push_back(static_cast<T>(overlap / scale));
+                }
+            }
+        } else {
+            const double center = (o + 0.5) * scale - 0.5;
+            const int s0 = static_cast<int>(std::floor(center));
+            const double frac = center - s0;
+            axis.taps.push_back(std::clamp(s0, 0, inSize - 1));
+            axis.weights.push_back(static_cast<T>(1.0 - frac));
+            axis.taps.push_back(std::clamp(s0 + 1, 0, inSize - 1));
+            axis.weights.push_back(static_cast<T>(frac));
+        }
+    }
+    axis.offsets.push_back(static_cast<int>(axis.taps.size()));
+    return axis;
+}
+
+template <typename T>
+T edgeDistance(T gx, T gy, T a)
+{
+    if (gx == 0 || gy == 0) {
+        return T(0.5) - a;
+    }
+    const T length = std::sqrt(gx * gx + gy * gy);
+    gx = std::abs(gx / length);
+    gy = std::abs(gy / length);
+    if (gx < gy) {
+        std::swap(gx, gy);
+    }
+    const T a1 = T(0.5) * gy / gx;
+    if (a < a1) {
+        return T(0.5) * (gx + gy) - std::sqrt(T(2) * gx * gy * a);
+    }
+    if (a < T(1) - a1) {
+        return (T(0.5) - a) * gx;
+    }
+    return T(-0.5) * (gx + gy) + std::sqrt(T(2) * gx * gy * (T(1) - a));
+}
+
+// Sobel-like gradient, normalized, at pixels strictly between 0 and 1.
+template <typename T>
+void computeGradient(const T *img, int width, int height, T *gx, T *gy)
+{
+    const T sqrt2 = std::sqrt(T(2));
+    std::fill(gx, gx + static_cast<size_t>(width) * height, T(0));
+    std::fill(gy, gy + static_cast<size_t>(width) * height, T(0));
+    for (int y = 1; y < height - 1; ++y) {
+        for (int x = 1; x < width - 1; ++x) {
+            const size_t k = static_cast<size_t>(y) * width + x;
+            if (img[k] <= 0 || img[k] >= 1) {
+                continue;
+            }
+            const T *up = img + k - width;
+            const T *down = img + k + width;
+            T u = -up[-1] - sqrt2 * img[k - 1] - down[-1] + up[1] + sqrt2 * img[k + 1] + down[1];
+            T v = -up[-1] - sqrt2 * up[0] - up[1] + down[-1] + sqrt2 * down[0] + down[1];
+            const T length = u * u + v * v;
+            if (length > 0) {
+                const T norm = std::sqrt(length);
+                u /= norm;
+                v /= norm;
+            }
+            gx[k] = u;
+            gy[k] = v;
+        }
+    }
+}
+
+// One EDTAA3 field: distance from background pixels to the edge of the
+// object described by img (1 = object). Every pixel tracks the integer
+// vector to its closest edge pixel; raster sweeps propagate vectors from
+// neighbours until nothing changes.
+template <typename T>
+bool edtaa3(const T *img, const T *gx, const T *gy, int width, int height, T *dist, std::atomic_bool *cancel)
+{
+    constexpr T kUnset = T(1000000);
+    constexpr T kEpsilon = T(1e-3);
+    const size_t count = static_cast<size_t>(width) * height;
+    std::vector<int> vx(count, 0);
+    std::vector<int> vy(count, 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (img[i] <= 0) {
+            dist[i] = kUnset;
+        } else if (img[i] < 1) {
+            dist[i] = edgeDistance(gx[i], gy[i], img[i]);
+        } else {
+            dist[i] = 0;
+        }
+    }
+
+    const auto distanceVia = [&](size_t closest, int dx, int dy) -> T {
+        const T a = std::clamp(img[closest], T(0), T(1));
+        if (a == 0) {
+            return kUnset;
+        }
+        const T di = std::sqrt(static_cast<T>(dx) * dx + static_cast<T>(dy) * dy);
+        const T df = di == 0 ? edgeDistance(gx[closest], gy[closest], a)
+                             : edgeDistance(static_cast<T>(dx), static_cast<T>(dy), a);
+        return di + df;
+    };
+
+    bool changed = false;
+    const auto relax = [&](int x, int y, int ox, int oy) {
+        const int nx = x + ox;
+        const int ny = y + oy;
+        if (nx < 0 || nx >= width || ny < 0 || ny >= height) {
+            return;
+        }
+        const size_t i = static_cast<size_t>(y) * width + x;
+        const size_t n = static_cast<size_t>(ny) * width + nx;
+        const int cx = vx[n];
+        const int cy = vy[n];
+        const size_t closest = n - cx - static_cast<std::ptrdiff_t>(cy) * width;
+        const int newX = cx - ox;
+        const int newY = cy - oy;
+        const T candidate = distanceVia(closest, newX, newY);
+        if (candidate < dist[i] - kEpsilon) {
+            vx[i] = newX;
+            vy[i] = newY;
+            dist[i] = candidate;
+            changed = true;
+        }
+    };
+    const auto pending = [&](int x, int y) {
+        return dist[static_cast<size_t>(y) * width + x] > 0;
+    };
+
+    do {
+        changed = false;
+        for (int y = 0; y < height; ++y) {
+            if (cancel && cancel->load()) {
+                return false;
+            }
+            for (int x = 0; x < width; ++x) {
+                if (pending(x, y)) {
+                    relax(x, y, -1, 0);
+                    relax(x, y, -1, -1);
+                    relax(x, y, 0, -1);
+                    relax(x, y, 1, -1);
+                }
+            }
+            for (int x = width - 1; x >= 0; --x) {
+                if (pending(x, y)) {
+                    relax(x, y, 1, 0);
+                }
+            }
+        }
+        for (int y = height - 1; y >= 0; --y) {
+            if (cancel && cancel->load()) {
+                return false;
+            }
+            for (int x = width - 1; x >= 0; --x) {
+                if (pending(x, y)) {
+                    relax(x, y, 1, 0);
+                    relax(x, y, 1, 1);
+                    relax(x, y, 0, 1);
+                    relax(x, y, -1, 1);
+                }
+            }
+            for (int x = 0; x < width; ++x) {
+                if (pending(x, y)) {
+                    relax(x, y, -1, 0);
+                }
+            }
+        }
+    } while (changed);
+
+    return true;
+}
+
+} // namespace
+
+template <typename T>
+std::vector<T> resampleCoverage(const GrayImageView &source, int width, int height, int threshold, std::atomic_bool *cancel)
+{
+    if (source.isNull() || width <= 0 || height <= 0) {
+        return {};
+    }
+
+    T levels[256];
+    const double knee = threshold + 0.5;
+    for (int g = 0; g < 256; ++g) {
+        const double a = g < knee ? 0.5 * g / knee : 0.5 + 0.5 * (g - knee) / (255.0 - knee);
+        levels[g] = static_cast<T>(std::clamp(a, 0.0, 1.0));
+    }
+
+    const AxisWeights<T> xAxis = axisWeights<T>(source.width, width);
+    const AxisWeights<T> yAxis = axisWeights<T>(source.height, height);
+
+    std::vector<T> rows(static_cast<size_t>(source.height) * width);
+    const auto rowBlock = [&](int start, int end) {
+        for (int sy = start; sy < end; ++sy) {
+            const std::uint8_t *line = source.row(sy);
+            T *dst = rows.data() + static_cast<size_t>(sy) * width;
+            for (int x = 0; x < width; ++x) {
+                T sum = 0;
+                for (int t = xAxis.offsets[x]; t < xAxis.offsets[x + 1]; ++t) {
+                    sum += xAxis.weights[t] * levels[line[xAxis.taps[t]]];
+                }
+                dst[x] = sum;
+            }
+        }
+    };
+    if (!runParallelBlocks(source.height, chooseBlockSize(source.height), cancel, rowBlock, [](int) {})) {
+        return {};
+    }
+
+    std::vector<T> coverage(static_cast<size_t>(width) * height, T(0));
+    const auto columnBlock = [&](int start, int end) {
+        for (int y = start; y < end; ++y) {
+            T *dst = coverage.data() + static_cast<size_t>(y) * width;
+            for (int t = yAxis.offsets[y]; t < yAxis.offsets[y + 1]; ++t) {
+                const T weight = yAxis.weights[t];
+                const T *src = rows.data() + static_cast<size_t>(yAxis.taps[t]) * width;
+                for (int x = 0; x < width; ++x) {
+                    dst[x] += weight * src[x];
+                }
+            }
+            for (int x = 0; x < width; ++x) {
+                dst[x] = std::clamp(dst[x], T(0), T(1));
+            }
+        }
+    };
+    if (!runParallelBlocks(height, chooseBlockSize(height), cancel, columnBlock, [](int) {})) {
+        return {};
+    }
+    return coverage;
+}
+
+template <typename T>
+bool antiAliasedSignedDistances(
+    Span<const T> coverage,
+    int width,
+    int height,
+    Span<T> signedDistances,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    const size_t count = static_cast<size_t>(width) * height;
+    if (width <= 0 || height <= 0 || coverage.size() != count || signedDistances.size() < count) {
+        return false;
+    }
+
+    std::vector<T> gx(count);
+    std::vector<T> gy(count);
+    computeGradient(coverage.data(), width, height, gx.data(), gy.data());
+
+    // The inverted image has the negated gradient; edgeDistance() only looks
+    // at its magnitude, so both fields share gx/gy.
+    std::vector<T> inverted(count);
+    for (size_t i = 0; i < count; ++i) {
+        inverted[i] = T(1) - coverage[i];
+    }
+
+    std::vector<T> outsideDist(count);
+    std::vector<T> insideDist(count);
+    std::atomic_bool failed(false);
+    const auto fieldBlock = [&](int start, int end) {
+        for (int field = start; field < end; ++field) {
+            const bool ok = field == 0
+                ? edtaa3(coverage.data(), gx.data(), gy.data(), width, height, outsideDist.data(), cancel)
+                : edtaa3(inverted.data(), gx.data(), gy.data(), width, height, insideDist.data(), cancel);
+            if (!ok) {
+                failed.store(true);
+            }
+        }
+    };
+    const auto reportField = [&](int delta) {
+        if (progressFn) {
+            progressFn(delta * (width + height));
+        }
+    };
+    if (!runParallelBlocks(2, 1, cancel, fieldBlock, reportField) || failed.load()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        signedDistances[i] = std::max(insideDist[i], T(0)) - std::max(outsideDist[i], T(0));
+    }
+    return true;
+}
+
+template std::vector<float> resampleCoverage<float>(const GrayImageView &, int, int, int, std::atomic_bool *);
+template std::vector<double> resampleCoverage<double>(const GrayImageView &, int, int, int, std::atomic_bool *);
+template bool antiAliasedSignedDistances<float>(
+    Span<const float>, int, int, Span<float>, std::atomic_bool *, const ProgressFn &);
+template bool antiAliasedSignedDistances<double>(
+    Span<const double>, int, int, Span<double>, std::atomic_bool *, const ProgressFn &);
+
+} // namespace sdf
@@ -0,0 +1,53 @@
+#ifndef SDF_ANTIALIASED_H
+#define SDF_ANTIALIASED_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include "Span.h"
+
+#include <atomic>
+#include <vector>
+
+namespace sdf {
+
+// Resamples the 8-bit source to a width x height coverage image in [0, 1]:
+// area-averaged when shrinking, linearly interpolated when enlarging. Gray
+// levels are remapped piecewise-linearly so that the threshold lands on the
+// 0.5 iso-level (for threshold 127 this is plain gray / 255). cancel is
+// checked per row block; returns an empty vector on invalid input or
+// cancellation.
+template <typename T>
+std::vector<T> resampleCoverage(
+    const GrayImageView &source,
+    int width,
+    int height,
+    int threshold,
+    std::atomic_bool *cancel);
+
+// Gustavson's anti-aliased Euclidean distance transform (EDTAA3): signed
+// distance from every pixel to the 0.5 iso-contour of coverage, positive
+// inside. Edge pixels use the local gradient and gray level to place the edge
+// with sub-pixel accuracy. The inside and outside fields are propagated in
+// parallel; progressFn receives 2 * (width + height) units. Returns false on
+// invalid input or cancellation.
+template <typename T>
+bool antiAliasedSignedDistances(
+    Span<const T> coverage,
+    int width,
+    int height,
+    Span<T> signedDistances,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+extern template std::vector<float> resampleCoverage<float>(
+    const GrayImageView &, int, int, int, std::atomic_bool *);
+extern template std::vector<double> resampleCoverage<double>(
+    const GrayImageView &, int, int, int, std::atomic_bool *);
+extern template bool antiAliasedSignedDistances<float>(
+    Span<const float>, int, int, Span<float>, std::atomic_bool *, const ProgressFn &);
+extern template bool antiAliasedSignedDistances<double>(
+    Span<const double>, int, int, Span<double>, std::atomic_bool *, const ProgressFn &);
+
+} // namespace sdf
+
+#endif // SDF_ANTIALIASED_H
@@ -0,0 +1,150 @@
+#include "BitMask.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SDF_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace sdf {
+
+namespace {
+
+inline int countTrailingZeros(BitMask::Word word)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+#ifdef SDF_HAVE_SSE2
+// 16 consecutive bytes > threshold as a 16-bit mask; above holds threshold + 1.
+inline unsigned thresholdBytes(__m128i bytes, __m128i above)
+{
+    const __m128i passed = _mm_cmpeq_epi8(_mm_max_epu8(bytes, above), bytes);
+    return static_cast<unsigned>(_mm_movemask_epi8(passed));
+}
+
+// Low byte of each 32-bit lane of four vectors, as 16 bytes.
+inline __m128i gatherLowBytes(const std::uint8_t *pixels)
+{
+    const __m128i low = _mm_set1_epi32(0xFF);
+    const __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels)), low);
+    const __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + 16)), low);
+    const __m128i c = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + 32)), low);
+    const __m128i d = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + 48)), low);
+    return _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+}
+#endif
+
+} // namespace
+
+BitMask::BitMask(int width, int height)
+    : maskWidth(width)
+    , maskHeight(height)
+{
+    if (width <= 0 || height <= 0) {
+        maskWidth = 0;
+        maskHeight = 0;
+        return;
+    }
+    rowWords = (static_cast<std::size_t>(width) + kWordBits - 1) / kWordBits;
+    words.assign(rowWords * height, 0);
+}
+
+void BitMask::unpackRow(int x0, int y, Span<std::uint8_t> line) const
+{
+    const Word *bits = row(y);
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        line[i] = bitAt(bits, x0 + static_cast<int>(i)) ? 1 : 0;
+    }
+}
+
+bool BitMask::rowHas(int y, int x0, int x1, bool value) const
+{
+    return x0 < x1 && findChange(row(y), x1, x0, !value) < x1;
+}
+
+int BitMask::findChange(const Word *row, int width, int x, bool value)
+{
+    if (x >= width) {
+        return width;
+    }
+    const Word flip = value ? ~Word(0) : Word(0);
+    int index = x / kWordBits;
+    Word differs = (row[index] ^ flip) & (~Word(0) << (x % kWordBits));
+    const int lastIndex = (width - 1) / kWordBits;
+    while (differs == 0) {
+        if (++index > lastIndex) {
+            return width;
+        }
+        differs = row[index] ^ flip;
+    }
+    return std::min(width, index * kWordBits + countTrailingZeros(differs));
+}
+
+void packThreshold(const std::uint8_t *pixels, int count, int pixelStride, int threshold, BitMask::Word *bits)
+{
+    const int wordCount = (count + BitMask::kWordBits - 1) / BitMask::kWordBits;
+    if (threshold >= 255 || threshold < 0) {
+        std::fill(bits, bits + wordCount, threshold < 0 ? ~BitMask::Word(0) : BitMask::Word(0));
+        if (threshold < 0 && count % BitMask::kWordBits != 0) {
+            bits[wordCount - 1] = (BitMask::Word(1) << (count % BitMask::kWordBits)) - 1;
+        }
+        return;
+    }
+
+    int x = 0;
+#ifdef SDF_HAVE_SSE2
+    const __m128i above = _mm_set1_epi8(static_cast<char>(threshold + 1));
+    if (pixelStride == 1 || pixelStride == 4) {
+        // A strided load reads up to three bytes past the last pixel's
+        // channel byte, so leave the final word of RGBA rows to the scalar loop.
+        const int slack = pixelStride == 4 ? 1 : 0;
+        for (; x + BitMask::kWordBits + slack <= count; x += BitMask::kWordBits) {
+            BitMask::Word word = 0;
+            for (int part = 0; part < 4; ++part) {
+                const std::uint8_t *src = pixels + static_cast<std::size_t>(x + 16 * part) * pixelStride;
+                const __m128i bytes = pixelStride == 1
+                    ? _mm_loadu_si128(reinterpret_cast<const __m128i *>(src))
+                    : gatherLowBytes(src);
+                word |= static_cast<BitMask::Word>(thresholdBytes(bytes, above)) << (16 * part);
+            }
+            bits[x / BitMask::kWordBits] = word;
+        }
+    }
+#endif
+    for (; x < count; x += BitMask::kWordBits) {
+        const int end = std::min(count, x + BitMask::kWordBits);
+        BitMask::Word word = 0;
+        for (int i = x; i < end; ++i) {
+            if (pixels[static_cast<std::size_t>(i) * pixelStride] > threshold) {
+                word |= BitMask::Word(1) << (i - x);
+            }
+        }
+        bits[x / BitMask::kWordBits] = word;
+    }
+}
+
+BitMask thresholdImage(const GrayImageView &image, int bytesPerPixel, int channel, int threshold)
+{
+    if (image.isNull() || bytesPerPixel <= 0 || channel < 0 || channel >= bytesPerPixel) {
+        return BitMask();
+    }
+    BitMask mask(image.width, image.height);
+    for (int y = 0; y < image.height; ++y) {
+        packThreshold(image.row(y) + channel, image.width, bytesPerPixel, threshold, mask.row(y));
+    }
+    return mask;
+}
+
+} // namespace sdf
@@ -0,0 +1,69 @@
+#ifndef SDF_BITMASK_H
+#define SDF_BITMASK_H
+
+#include "ImageView.h"
+#include "Span.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sdf {
+
+// Binary image packed one bit per pixel (set = inside). Bit x of a row lives
+// in word x / 64 at position x % 64; every row starts on a new word and the
+// padding bits past width are always clear.
+class BitMask
+{
+public:
+    using Word = std::uint64_t;
+    static constexpr int kWordBits = 64;
+
+    BitMask() = default;
+    // All pixels clear.
+    BitMask(int width, int height);
+
+    int width() const { return maskWidth; }
+    int height() const { return maskHeight; }
+    std::size_t wordsPerRow() const { return rowWords; }
+    bool isNull() const { return words.empty(); }
+
+    Word *row(int y) { return words.data() + static_cast<std::size_t>(y) * rowWords; }
+    const Word *row(int y) const { return words.data() + static_cast<std::size_t>(y) * rowWords; }
+
+    bool get(int x, int y) const { return bitAt(row(y), x); }
+
+    // Writes 0 / 1 bytes for columns [x0, x0 + line.size()) of row y.
+    void unpackRow(int x0, int y, Span<std::uint8_t> line) const;
+
+    // True if row y has a pixel equal to value in columns [x0, x1).
+    bool rowHas(int y, int x0, int x1, bool value) const;
+
+    static bool bitAt(const Word *row, int x) { return ((row[x / kWordBits] >> (x % kWordBits)) & 1) != 0; }
+
+    // First column at or after x whose bit differs from value, or width if
+    // the run of value reaches the end of the row. Scans a word at a time.
+    static int findChange(const Word *row, int width, int x, bool value);
+
+private:
+    int maskWidth = 0;
+    int maskHeight = 0;
+    std::size_t rowWords = 0;
+    std::vector<Word> words;
+};
+
+// Packs count pixels spaced pixelStride bytes apart into bits: a bit is set
+// where the byte is > threshold. bits must hold (count + 63) / 64 words;
+// the trailing bits of the last word are cleared. Gray (stride 1) and RGBA
+// (stride 4, pixels pointing at the wanted channel) rows use SSE2 when
+// available.
+void packThreshold(const std::uint8_t *pixels, int count, int pixelStride, int threshold, BitMask::Word *bits);
+
+// Thresholds every row of image into a mask of the same size. image.width is
+// in pixels and image.stride in bytes; channel selects the byte inside each
+// bytesPerPixel-sized pixel (e.g. 1 / 0 for gray, 4 / 3 for RGBA alpha).
+BitMask thresholdImage(const GrayImageView &image, int bytesPerPixel, int channel, int threshold);
+
+} // namespace sdf
+
+#endif // SDF_BITMASK_H
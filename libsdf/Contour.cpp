@@ -0,0 +1,376 @@
+#include "Contour.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace sdf {
+
+namespace {
+
+constexpr std::uint32_t kLeafSize = 8;
+constexpr std::uint32_t kNoItem = 0xFFFFFFFFu;
+
+// Point where the iso-level crosses the edge from sample a to sample b. Each
+// edge is always walked in the same direction (left to right, top to
+// bottom), so neighbouring cells produce bit-identical shared endpoints.
+struct EdgePoint
+{
+    float x;
+    float y;
+};
+
+EdgePoint edgePoint(float ax, float ay, float va, float bx, float by, float vb, float iso)
+{
+    const float t = std::clamp((iso - va) / (vb - va), 0.0f, 1.0f);
+    return {ax + t * (bx - ax), ay + t * (by - ay)};
+}
+
+} // namespace
+
+float squaredSegmentDistance(const ContourSegment &s, float x, float y)
+{
+    const float dx = s.x1 - s.x0;
+    const float dy = s.y1 - s.y0;
+    const float px = x - s.x0;
+    const float py = y - s.y0;
+    const float lengthSq = dx * dx + dy * dy;
+    float t = lengthSq > 0.0f ? (px * dx + py * dy) / lengthSq : 0.0f;
+    t = std::clamp(t, 0.0f, 1.0f);
+    const float ex = px - t * dx;
+    const float ey = py - t * dy;
+    return ex * ex + ey * ey;
+}
+
+SegmentTree::SegmentTree(std::vector<ContourSegment> segments)
+    : items(std::move(segments))
+{
+    if (!items.empty()) {
+        nodes.reserve(2 * (items.size() / kLeafSize + 1));
+        nodes.resize(1);
+        build(0, 0, static_cast<std::uint32_t>(items.size()));
+    }
+}
+
+void SegmentTree::build(std::uint32_t slot, std::uint32_t begin, std::uint32_t end)
+{
+    Node node;
+    node.minX = node.minY = std::numeric_limits<float>::max();
+    node.maxX = node.maxY = std::numeric_limits<float>::lowest();
+    for (std::uint32_t i = begin; i < end; ++i) {
+        const ContourSegment &s = items[i];
+        node.minX = std::min({node.minX, s.x0, s.x1});
+        node.minY = std::min({node.minY, s.y0, s.y1});
+        node.maxX = std::max({node.maxX, s.x0, s.x1});
+        node.maxY = std::max({node.maxY, s.y0, s.y1});
+    }
+
+    if (end - begin <= kLeafSize) {
+        node.first = begin;
+        node.count = end - begin;
+        nodes[slot] = node;
+        return;
+    }
+
+    // Median split on the segment midpoints along the longer axis; the two
+    // children are stored next to each other.
+    const bool splitX = node.maxX - node.minX >= node.maxY - node.minY;
+    const std::uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+                     [splitX](const ContourSegment &a, const ContourSegment &b) {
+                         return splitX ? a.x0 + a.x1 < b.x0 + b.x1 : a.y0 + a.y1 < b.y0 + b.y1;
+                     });
+    node.first = static_cast<std::uint32_t>(nodes.size());
+    node.count = 0;
+    nodes[slot] = node;
+    nodes.resize(nodes.size() + 2);
+    build(node.first, begin, middle);
+    build(node.first + 1, middle, end);
+}
+
+float SegmentTree::nearest(float x, float y, float bound, std::uint32_t *hint) const
+{
+    if (items.empty()) {
+        return bound;
+    }
+    const auto boxDistanceSq = [x, y](const Node &node) {
+        const float dx = std::max({node.minX - x, 0.0f, x - node.maxX});
+        const float dy = std::max({node.minY - y, 0.0f, y - node.maxY});
+        return dx * dx + dy * dy;
+    };
+
+    const float boundSq = bound * bound;
+    float bestSq = boundSq;
+    std::uint32_t best = kNoItem;
+    if (hint && *hint < items.size()) {
+        const float hintSq = squaredSegmentDistance(items[*hint], x, y);
+        if (hintSq < bestSq) {
+            bestSq = hintSq;
+            best = *hint;
+        }
+    }
+    std::uint32_t stack[64];
+    int depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const Node &node = nodes[stack[--depth]];
+        if (boxDistanceSq(node) >= bestSq) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+                const float distanceSq = squaredSegmentDistance(items[i], x, y);
+                if (distanceSq < bestSq) {
+                    bestSq = distanceSq;
+                    best = i;
+                }
+            }
+            continue;
+        }
+        // Nearer child on top of the stack.
+        const float leftSq = boxDistanceSq(nodes[node.first]);
+        const float rightSq = boxDistanceSq(nodes[node.first + 1]);
+        const std::uint32_t nearChild = leftSq <= rightSq ? node.first : node.first + 1;
+        const std::uint32_t farChild = leftSq <= rightSq ? node.first + 1 : node.first;
+        stack[depth++] = farChild;
+        stack[depth++] = nearChild;
+    }
+    if (hint) {
+        *hint = best;
+    }
+    return bestSq < boundSq ? std::sqrt(bestSq) : bound;
+}
+
+std::size_t SegmentTree::candidates(
+    float minX,
+    float minY,
+    float maxX,
+    float maxY,
+    float bound,
+    Candidate *out) const
+{
+    if (items.empty()) {
+        return 0;
+    }
+    const auto gapSq = [&](const Node &node) {
+        const float dx = std::max({node.minX - maxX, 0.0f, minX - node.maxX});
+        const float dy = std::max({node.minY - maxY, 0.0f, minY - node.maxY});
+        return dx * dx + dy * dy;
+    };
+
+    const float boundSq = bound * bound;
+    std::size_t count = 0;
+    std::uint32_t stack[64];
+    int depth = 0;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        const std::uint32_t index = stack[--depth];
+        const Node &node = nodes[index];
+        const float nodeGapSq = gapSq(node);
+        if (nodeGapSq >= boundSq) {
+            continue;
+        }
+        if (node.count > 0) {
+            out[count++] = {nodeGapSq, index};
+            continue;
+        }
+        stack[depth++] = node.first;
+        stack[depth++] = node.first + 1;
+    }
+    std::sort(out, out + count, [](const Candidate &a, const Candidate &b) { return a.gapSq < b.gapSq; });
+    return count;
+}
+
+float SegmentTree::nearestAmong(
+    Span<const Candidate> leaves,
+    float x,
+    float y,
+    float bound,
+    std::uint32_t *hint) const
+{
+    const float boundSq = bound * bound;
+    float bestSq = boundSq;
+    std::uint32_t best = kNoItem;
+    if (hint && *hint < items.size()) {
+        const float hintSq = squaredSegmentDistance(items[*hint], x, y);
+        if (hintSq < bestSq) {
+            bestSq = hintSq;
+            best = *hint;
+        }
+    }
+    for (const Candidate &leaf : leaves) {
+        if (leaf.gapSq >= bestSq) {
+            break;
+        }
+        const Node &node = nodes[leaf.node];
+        const float dx = std::max({node.minX - x, 0.0f, x - node.maxX});
+        const float dy = std::max({node.minY - y, 0.0f, y - node.maxY});
+        if (dx * dx + dy * dy >= bestSq) {
+            continue;
+        }
+        for (std::uint32_t i = node.first; i < node.first + node.count; ++i) {
+            const float distanceSq = squaredSegmentDistance(items[i], x, y);
+            if (distanceSq < bestSq) {
+                bestSq = distanceSq;
+                best = i;
+            }
+        }
+    }
+    if (hint) {
+        *hint = best;
+    }
+    return bestSq < boundSq ? std::sqrt(bestSq) : bound;
+}
+
+Contour Contour::extract(const GrayImageView &source, int threshold, std::atomic_bool *cancel)
+{
+    if (source.isNull()) {
+        return Contour();
+    }
+    const int width = source.width;
+    const int height = source.height;
+    const float iso = static_cast<float>(threshold) + 0.5f;
+    // Sample (i, j) sits at the centre of pixel (i, j); the ring around the
+    // image reads as outside.
+    const auto sample = [&](int i, int j) -> float {
+        if (i < 0 || j < 0 || i >= width || j >= height) {
+            return 0.0f;
+        }
+        return static_cast<float>(source.row(j)[i]);
+    };
+    const auto inside = [iso](float v) { return v > iso; };
+
+    // Cell row r holds the cells between sample rows r - 1 and r.
+    std::vector<std::vector<ContourSegment>> rows(static_cast<size_t>(height) + 1);
+    const auto rowBlock = [&](int start, int end) {
+        for (int r = start; r < end; ++r) {
+            if (cancel && cancel->load()) {
+                return;
+            }
+            std::vector<ContourSegment> &out = rows[static_cast<size_t>(r)];
+            const int j = r - 1;
+            const float top = static_cast<float>(j) + 0.5f;
+            const float bottom = top + 1.0f;
+            for (int i = -1; i < width; ++i) {
+                const float tl = sample(i, j);
+                const float tr = sample(i + 1, j);
+                const float br = sample(i + 1, j + 1);
+                const float bl = sample(i, j + 1);
+                const int code = (inside(tl) ? 1 : 0) | (inside(tr) ? 2 : 0) | (inside(br) ? 4 : 0)
+                    | (inside(bl) ? 8 : 0);
+                if (code == 0 || code == 15) {
+                    continue;
+                }
+                const float left = static_cast<float>(i) + 0.5f;
+                const float right = left + 1.0f;
+                const auto topEdge = [&]() { return edgePoint(left, top, tl, right, top, tr, iso); };
+                const auto rightEdge = [&]() { return edgePoint(right, top, tr, right, bottom, br, iso); };
+                const auto bottomEdge = [&]() { return edgePoint(left, bottom, bl, right, bottom, br, iso); };
+                const auto leftEdge = [&]() { return edgePoint(left, top, tl, left, bottom, bl, iso); };
+                const auto addSegment = [&out](EdgePoint a, EdgePoint b) { out.push_back({a.x, a.y, b.x, b.y}); };
+                // Saddles are joined through the centre when its average
+                // is inside.
+                const bool centreInside = inside((tl + tr + br + bl) * 0.25f);
+                switch (code) {
+                case 1:
+                case 14:
+                    addSegment(leftEdge(), topEdge());
+                    break;
+                case 2:
+                case 13:
+                    addSegment(topEdge(), rightEdge());
+                    break;
+                case 3:
+                case 12:
+                    addSegment(leftEdge(), rightEdge());
+                    break;
+                case 4:
+                case 11:
+                    addSegment(rightEdge(), bottomEdge());
+                    break;
+                case 6:
+                case 9:
+                    addSegment(topEdge(), bottomEdge());
+                    break;
+                case 7:
+                case 8:
+                    addSegment(leftEdge(), bottomEdge());
+                    break;
+                case 5:
+                    if (centreInside) {
+                        addSegment(topEdge(), rightEdge());
+                        addSegment(leftEdge(), bottomEdge());
+                    } else {
+                        addSegment(leftEdge(), topEdge());
+                        addSegment(rightEdge(), bottomEdge());
+                    }
+                    break;
+                case 10:
+                    if (centreInside) {
+                        addSegment(leftEdge(), topEdge());
+                        addSegment(rightEdge(), bottomEdge());
+                    } else {
+                        addSegment(topEdge(), rightEdge());
+                        addSegment(leftEdge(), bottomEdge());
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+    };
+    if (!runParallelBlocks(height + 1, chooseBlockSize(height + 1), cancel, rowBlock, [](int) {})) {
+        return Contour();
+    }
+
+    Contour contour;
+    contour.sourceWidth = width;
+    contour.sourceHeight = height;
+    contour.rowStart.reserve(rows.size() + 1);
+    for (const std::vector<ContourSegment> &row : rows) {
+        contour.rowStart.push_back(static_cast<std::uint32_t>(contour.segments.size()));
+        contour.segments.insert(contour.segments.end(), row.begin(), row.end());
+    }
+    contour.rowStart.push_back(static_cast<std::uint32_t>(contour.segments.size()));
+    contour.segmentTree = SegmentTree(contour.segments);
+    return contour;
+}
+
+int Contour::cellRow(float y) const
+{
+    // Cell row r spans y in [r - 0.5, r + 0.5].
+    const float r = std::floor(y + 0.5f);
+    if (!(r >= 0.0f) || r > static_cast<float>(sourceHeight)) {
+        return -1;
+    }
+    return static_cast<int>(r);
+}
+
+int Contour::maxCrossings(float y) const
+{
+    const int r = cellRow(y);
+    return r < 0 ? 0 : static_cast<int>(rowStart[r + 1] - rowStart[r]);
+}
+
+int Contour::crossings(float y, float *xs) const
+{
+    const int r = cellRow(y);
+    if (r < 0) {
+        return 0;
+    }
+    int count = 0;
+    for (std::uint32_t i = rowStart[r]; i < rowStart[r + 1]; ++i) {
+        const ContourSegment &s = segments[i];
+        // Half-open in y, so a vertex shared by two segments counts once.
+        if ((s.y0 <= y) != (s.y1 <= y)) {
+            const float t = (y - s.y0) / (s.y1 - s.y0);
+            xs[count++] = s.x0 + t * (s.x1 - s.x0);
+        }
+    }
+    std::sort(xs, xs + count);
+    return count;
+}
+
+} // namespace sdf
@@ -0,0 +1,132 @@
+#ifndef SDF_CONTOUR_H
+#define SDF_CONTOUR_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include "Span.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sdf {
+
+// Line segment in source pixel coordinates (pixel (x, y) covers
+// [x, x + 1) x [y, y + 1)).
+struct ContourSegment
+{
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+};
+
+// Squared distance from (x, y) to the segment.
+float squaredSegmentDistance(const ContourSegment &segment, float x, float y);
+
+// Bounding volume hierarchy over line segments for nearest-distance queries.
+class SegmentTree
+{
+public:
+    SegmentTree() = default;
+    explicit SegmentTree(std::vector<ContourSegment> segments);
+
+    bool isEmpty() const { return items.empty(); }
+
+    // Distance from (x, y) to the nearest segment, or bound if no segment
+    // is closer than bound. Subtrees farther than the best distance so far
+    // are skipped. hint, if given, names a segment to try first (typically
+    // the answer for a neighbouring point, which makes the search start
+    // from a nearly exact bound) and receives the nearest segment found.
+    float nearest(float x, float y, float bound, std::uint32_t *hint = nullptr) const;
+
+    // Leaf of the tree near a query box, with the squared gap between the
+    // two boxes.
+    struct Candidate
+    {
+        float gapSq;
+        std::uint32_t node;
+    };
+
+    // Upper bound on the number of candidates() results.
+    std::size_t maxCandidates() const { return nodes.size(); }
+
+    // Writes the leaves whose box comes within bound of the box
+    // [minX, maxX] x [minY, maxY], nearest first, and returns their count;
+    // 0 when every point of the box is at least bound from every segment.
+    std::size_t candidates(float minX, float minY, float maxX, float maxY, float bound, Candidate *out) const;
+
+    // nearest() for a point inside the box the candidates were gathered
+    // for, with the same bound: only those leaves are searched, and the
+    // search stops at the first leaf whose gap reaches the best distance.
+    float nearestAmong(Span<const Candidate> leaves, float x, float y, float bound,
+                       std::uint32_t *hint = nullptr) const;
+
+private:
+    struct Node
+    {
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        // Leaves: items [first, first + count). Inner nodes: count == 0,
+        // children at first and first + 1.
+        std::uint32_t first;
+        std::uint32_t count;
+    };
+
+    void build(std::uint32_t slot, std::uint32_t begin, std::uint32_t end);
+
+    std::vector<ContourSegment> items;
+    std::vector<Node> nodes;
+};
+
+// Sub-pixel boundary of a thresholded grayscale image: marching squares over
+// the pixel centres at the iso-level threshold + 0.5, so that the contour
+// separates exactly the pixels > threshold from the rest and gray edge
+// pixels place it between them. The image is padded with outside pixels, so
+// every loop is closed. Extract it once; generateSdfFromContour() then
+// evaluates exact distances to it at any output size without touching the
+// raster again.
+class Contour
+{
+public:
+    Contour() = default;
+
+    // Rows are processed in parallel. Returns an empty contour (with the
+    // source size) for a uniform image, and a null one on invalid input or
+    // cancellation.
+    static Contour extract(const GrayImageView &source, int threshold, std::atomic_bool *cancel);
+
+    bool isNull() const { return sourceWidth <= 0 || sourceHeight <= 0; }
+    int width() const { return sourceWidth; }
+    int height() const { return sourceHeight; }
+    std::size_t segmentCount() const { return segments.size(); }
+    const std::vector<ContourSegment> &segmentList() const { return segments; }
+    const SegmentTree &tree() const { return segmentTree; }
+
+    // Upper bound on the number of crossings() results for line y.
+    int maxCrossings(float y) const;
+
+    // Sorted x positions where the horizontal line y crosses the contour;
+    // a point is inside when an odd number of them lie to its left. Writes
+    // at most maxCrossings(y) values and returns their count.
+    int crossings(float y, float *xs) const;
+
+private:
+    // Cell row of the segments crossing line y, or -1 if none can.
+    int cellRow(float y) const;
+
+    int sourceWidth = 0;
+    int sourceHeight = 0;
+    // Segments grouped by marching squares cell row; row r (cells between
+    // pixel rows r - 1 and r) owns [rowStart[r], rowStart[r + 1]).
+    std::vector<ContourSegment> segments;
+    std::vector<std::uint32_t> rowStart;
+    SegmentTree segmentTree;
+};
+
+} // namespace sdf
+
+#endif // SDF_CONTOUR_H
@@ -0,0 +1,867 @@
+#include "DistanceTransform.h"
+
+#include "MappedBuffer.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <mutex>
+
+namespace sdf {
+
+namespace {
+
+std::mutex skipMutex;
+SkipStats skipTotals;
+
+void addPassSkips(PassSkipStats &total, const PassSkipStats &counts)
+{
+    total.lines += counts.lines;
+    total.uniformLines += counts.uniformLines;
+    total.samples += counts.samples;
+    total.skippedSamples += counts.skippedSamples;
+}
+
+// Adds one line of n samples, skipped of which never entered an envelope.
+void countLine(PassSkipStats &counts, int n, int skipped)
+{
+    ++counts.lines;
+    counts.uniformLines += skipped == n ? 1 : 0;
+    counts.samples += static_cast<std::uint64_t>(n);
+    counts.skippedSamples += static_cast<std::uint64_t>(skipped);
+}
+
+// Column tiles span two 64-byte cache lines of each row.
+template <typename T>
+constexpr int columnTileWidth()
+{
+    return static_cast<int>(128 / sizeof(T));
+}
+
+// Gathers tw columns starting at src (row stride width) into dst, one
+// contiguous run of height values per column.
+template <typename T>
+void transposeTileToColumns(const T *src, int width, int height, int tw, T *dst)
+{
+    for (int y = 0; y < height; ++y) {
+        const T *row = src + static_cast<size_t>(y) * width;
+        for (int c = 0; c < tw; ++c) {
+            dst[static_cast<size_t>(c) * height + y] = row[c];
+        }
+    }
+}
+
+template <typename T>
+void transposeColumnsToTile(const T *src, int width, int height, int tw, T *dst)
+{
+    for (int y = 0; y < height; ++y) {
+        T *row = dst + static_cast<size_t>(y) * width;
+        for (int c = 0; c < tw; ++c) {
+            row[c] = src[static_cast<size_t>(c) * height + y];
+        }
+    }
+}
+
+// Floor of num / den for den > 0.
+inline std::int64_t floorDiv(std::int64_t num, std::int64_t den)
+{
+    return num >= 0 ? num / den : -((-num + den - 1) / den);
+}
+
+// True if every value of the line equals the first.
+template <typename FieldFn>
+bool isUniformLine(const FieldFn &f, int n)
+{
+    const auto first = f(0);
+    for (int q = 1; q < n; ++q) {
+        if (f(q) != first) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether sample q can be the nearest site of any other sample. An infinite
+// sample never is while a finite one exists, and a seed between two seeds
+// is beaten by one of them everywhere but at its own position, where the
+// result is 0 anyway.
+template <typename FieldFn, typename T>
+inline bool isEnvelopeSite(const FieldFn &f, int q, int n, T inf)
+{
+    const T value = f(q);
+    if (value == 0) {
+        return q == 0 || q == n - 1 || f(q - 1) != 0 || f(q + 1) != 0;
+    }
+    return value < inf;
+}
+
+// One site push of the integer lower envelope, see the SquaredDistance
+// transformLine. k is -1 for an empty envelope.
+template <typename FieldFn>
+inline void pushExactSite(const FieldFn &f, int q, int *v, std::int64_t *z, int &k)
+{
+    constexpr std::int64_t zMin = std::numeric_limits<std::int64_t>::min();
+    constexpr std::int64_t zMax = std::numeric_limits<std::int64_t>::max();
+    const std::int64_t fq = static_cast<std::int64_t>(f(q)) + static_cast<std::int64_t>(q) * q;
+    std::int64_t s = zMin;
+    while (k >= 0) {
+        const int vk = v[k];
+        const std::int64_t fv = static_cast<std::int64_t>(f(vk)) + static_cast<std::int64_t>(vk) * vk;
+        s = floorDiv(fq - fv, 2 * static_cast<std::int64_t>(q - vk));
+        if (s > z[k]) {
+            break;
+        }
+        --k;
+    }
+    ++k;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = zMax;
+}
+
+template <typename FieldFn>
+inline SquaredDistance queryExactSite(const FieldFn &f, int q, const int *v, const std::int64_t *z, int &k)
+{
+    constexpr SquaredDistance inf = kInfinityValue<SquaredDistance>;
+    while (z[k + 1] < q) {
+        ++k;
+    }
+    const int vk = v[k];
+    const std::int64_t dx = q - vk;
+    const SquaredDistance fv = f(vk);
+    const std::int64_t value = dx * dx + fv;
+    return fv == inf || value >= inf ? inf : static_cast<SquaredDistance>(value);
+}
+
+// Squared distances of the pixels of run [start, end) of a row of n pixels
+// to the nearest pixel of the other class, which are the ones just before
+// and just after the run.
+void fillRunDistances(int start, int end, int n, SquaredDistance *d)
+{
+    constexpr SquaredDistance inf = kInfinityValue<SquaredDistance>;
+    for (int x = start; x < end; ++x) {
+        const int toLeft = start > 0 ? x - start + 1 : n;
+        const int toRight = end < n ? end - x : n;
+        const auto gap = static_cast<std::uint64_t>(std::min(toLeft, toRight));
+        d[x] = static_cast<SquaredDistance>(std::min<std::uint64_t>(gap * gap, inf));
+    }
+}
+
+// Squared distance along one mask row to the nearest pixel of the other
+// class, kInfinityValue when the row has only one class. Runs of equal
+// pixels are found a word at a time. Returns true for a row of one class.
+bool oppositeRowDistances(const BitMask::Word *bits, int n, SquaredDistance *d)
+{
+    int start = 0;
+    while (start < n) {
+        const int end = BitMask::findChange(bits, n, start, BitMask::bitAt(bits, start));
+        if (start == 0 && end == n) {
+            std::fill(d, d + n, kInfinityValue<SquaredDistance>);
+            return true;
+        }
+        fillRunDistances(start, end, n, d);
+        start = end;
+    }
+    return false;
+}
+
+// The same from the toggle columns of a RunMask row: the runs are given, so
+// finding them costs nothing.
+bool oppositeRowDistances(Span<const int> toggles, int n, SquaredDistance *d)
+{
+    if (toggles.empty() || (toggles.size() == 1 && toggles[0] == 0)) {
+        std::fill(d, d + n, kInfinityValue<SquaredDistance>);
+        return true;
+    }
+    int start = 0;
+    for (const int toggle : toggles) {
+        fillRunDistances(start, toggle, n, d);
+        start = toggle;
+    }
+    fillRunDistances(start, n, n, d);
+    return false;
+}
+
+// Both fields of one column in a single sweep: the distance to outside
+// (seeded by mask == 0) and to inside (mask != 0) share the row-pass values
+// in h, since each pixel's own-class field is 0. Each pixel keeps the field
+// of the opposite class, so a field is neither built nor queried when the
+// column has no pixel that needs it. Both fields are added to counts.
+void signedColumn1D(
+    const SquaredDistance *h,
+    const std::uint8_t *mask,
+    int n,
+    SquaredDistance *d,
+    PassSkipStats &counts)
+{
+    constexpr SquaredDistance inf = kInfinityValue<SquaredDistance>;
+    ScratchArena &arena = ScratchArena::local();
+    int *v = arena.get<int>(ScratchArena::EnvelopeSites, 2 * static_cast<size_t>(n));
+    std::int64_t *z = arena.get<std::int64_t>(ScratchArena::EnvelopeBounds, 2 * (static_cast<size_t>(n) + 1));
+    int *vIn = v + n;
+    std::int64_t *zIn = z + n + 1;
+
+    const auto toOutside = [h, mask](int i) -> SquaredDistance {
+        return mask[i] ? h[i] : 0;
+    };
+    const auto toInside = [h, mask](int i) -> SquaredDistance {
+        return mask[i] ? 0 : h[i];
+    };
+
+    const std::uint8_t *maskEnd = mask + n;
+    const bool needOutside = std::find(mask, maskEnd, 1) != maskEnd;
+    const bool needInside = std::find(mask, maskEnd, 0) != maskEnd;
+    int k = -1;
+    int kIn = -1;
+    int skippedOutside = needOutside ? 0 : n;
+    int skippedInside = needInside ? 0 : n;
+    for (int q = 0; q < n; ++q) {
+        if (needOutside) {
+            if (isEnvelopeSite(toOutside, q, n, inf)) {
+                pushExactSite(toOutside, q, v, z, k);
+            } else {
+                ++skippedOutside;
+            }
+        }
+        if (needInside) {
+            if (isEnvelopeSite(toInside, q, n, inf)) {
+                pushExactSite(toInside, q, vIn, zIn, kIn);
+            } else {
+                ++skippedInside;
+            }
+        }
+    }
+    countLine(counts, n, skippedOutside);
+    countLine(counts, n, skippedInside);
+
+    const bool outsideEmpty = k < 0;
+    const bool insideEmpty = kIn < 0;
+    k = 0;
+    kIn = 0;
+    for (int q = 0; q < n; ++q) {
+        if (mask[q]) {
+            d[q] = outsideEmpty ? inf : queryExactSite(toOutside, q, v, z, k);
+        } else {
+            d[q] = insideEmpty ? inf : queryExactSite(toInside, q, vIn, zIn, kIn);
+        }
+    }
+}
+
+// Felzenszwalb/Huttenlocher envelope over the samples that can be nearest
+// to another one, see isEnvelopeSite; seeds skipped that way are written as
+// 0 directly. Returns the number of samples that did not enter the envelope.
+template <typename T>
+int transformLine(const T *f, int n, T *d)
+{
+    constexpr T inf = kInfinityValue<T>;
+    const auto field = [f](int i) { return f[i]; };
+    if (isUniformLine(field, n)) {
+        std::copy_n(f, n, d);
+        return n;
+    }
+
+    ScratchArena &arena = ScratchArena::local();
+    int *v = arena.get<int>(ScratchArena::EnvelopeSites, n);
+    T *z = arena.get<T>(ScratchArena::EnvelopeBounds, static_cast<size_t>(n) + 1);
+    int k = -1;
+    int skipped = 0;
+    for (int q = 0; q < n; ++q) {
+        if (!isEnvelopeSite(field, q, n, inf)) {
+            ++skipped;
+            continue;
+        }
+        T s = -inf;
+        while (k >= 0) {
+            const int vk = v[k];
+            s = ((f[q] + T(q) * q) - (f[vk] + T(vk) * vk)) / (T(2) * (q - vk));
+            if (s > z[k]) {
+                break;
+            }
+            --k;
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = inf;
+    }
+    if (k < 0) {
+        std::fill(d, d + n, inf);
+        return n;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        if (f[q] == 0) {
+            d[q] = 0;
+            continue;
+        }
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        const int vk = v[k];
+        const T dx = static_cast<T>(q - vk);
+        d[q] = dx * dx + f[vk];
+    }
+    return skipped;
+}
+
+// Same lower envelope with integer bounds: z[k] holds the floor of the real
+// intersection. Popping on floor(s) <= floor(z) only drops parabolas that are
+// minimal on an interval without integer samples, so the result is exact.
+int transformLine(const SquaredDistance *f, int n, SquaredDistance *d)
+{
+    constexpr SquaredDistance inf = kInfinityValue<SquaredDistance>;
+    const auto field = [f](int i) { return f[i]; };
+    if (isUniformLine(field, n)) {
+        std::copy_n(f, n, d);
+        return n;
+    }
+
+    ScratchArena &arena = ScratchArena::local();
+    int *v = arena.get<int>(ScratchArena::EnvelopeSites, n);
+    std::int64_t *z = arena.get<std::int64_t>(ScratchArena::EnvelopeBounds, static_cast<size_t>(n) + 1);
+    int k = -1;
+    int skipped = 0;
+    for (int q = 0; q < n; ++q) {
+        if (isEnvelopeSite(field, q, n, inf)) {
+            pushExactSite(field, q, v, z, k);
+        } else {
+            ++skipped;
+        }
+    }
+    if (k < 0) {
+        std::fill(d, d + n, inf);
+        return n;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        d[q] = f[q] == 0 ? 0 : queryExactSite(field, q, v, z, k);
+    }
+    return skipped;
+}
+
+} // namespace
+
+Precision resolvePrecision(Precision requested, bool binaryInput, bool eightBitOutput)
+{
+    if (requested != Precision::Auto) {
+        return requested;
+    }
+    if (binaryInput) {
+        return Precision::Exact;
+    }
+    return eightBitOutput ? Precision::Float : Precision::Double;
+}
+
+SkipStats skipStats()
+{
+    std::lock_guard<std::mutex> lock(skipMutex);
+    return skipTotals;
+}
+
+void resetSkipStats()
+{
+    std::lock_guard<std::mutex> lock(skipMutex);
+    skipTotals = SkipStats();
+}
+
+namespace detail {
+
+void recordPassSkips(bool columnPass, const PassSkipStats &counts)
+{
+    std::lock_guard<std::mutex> lock(skipMutex);
+    addPassSkips(columnPass ? skipTotals.columnPass : skipTotals.rowPass, counts);
+}
+
+void recordTileSkips(std::uint64_t tiles, std::uint64_t uniformTiles)
+{
+    std::lock_guard<std::mutex> lock(skipMutex);
+    skipTotals.tiles += tiles;
+    skipTotals.uniformTiles += uniformTiles;
+}
+
+} // namespace detail
+
+template <typename T>
+void distanceTransform1D(Span<const T> f, Span<T> d)
+{
+    if (!f.empty()) {
+        transformLine(f.data(), static_cast<int>(f.size()), d.data());
+    }
+}
+
+template <>
+void distanceTransform1D<SquaredDistance>(Span<const SquaredDistance> f, Span<SquaredDistance> d)
+{
+    if (!f.empty()) {
+        transformLine(f.data(), static_cast<int>(f.size()), d.data());
+    }
+}
+
+namespace {
+
+// Row pass output between the two passes of a transform. When the buffer is
+// file-backed it is stored in vertical stripes, one per column block, each
+// row-major and contiguous: the row pass then writes and every column block
+// reads a single sequential range, and a finished stripe can be dropped
+// without writeback. On the heap the stripe spans the image, which is the
+// plain row-major layout.
+template <typename T>
+class RowPassBuffer
+{
+public:
+    RowPassBuffer(int width, int height, int columnBlock)
+        : buffer(static_cast<size_t>(width) * height * sizeof(T))
+        , width(width)
+        , height(height)
+        , stripeWidth(buffer.isMapped() ? columnBlock : width)
+    {
+        buffer.advise(MappedBuffer::Access::Sequential, 0, buffer.size());
+    }
+
+    bool isStriped() const { return stripeWidth < width; }
+
+    // Destination for row y when the layout is not striped.
+    T *row(int y) const { return buffer.data<T>() + static_cast<size_t>(y) * width; }
+
+    // Copies a finished row into the stripes.
+    void storeRow(int y, const T *values) const
+    {
+        for (int x0 = 0; x0 < width; x0 += stripeWidth) {
+            const int cols = stripeCols(x0);
+            std::copy_n(values + x0, cols, stripe(x0) + static_cast<size_t>(y) * cols);
+        }
+    }
+
+    // Start of column x and the row stride of its stripe.
+    const T *column(int x) const
+    {
+        const int x0 = x / stripeWidth * stripeWidth;
+        return stripe(x0) + (x - x0);
+    }
+    int columnStride(int x) const { return stripeCols(x / stripeWidth * stripeWidth); }
+
+    // Releases columns [start, end), whole stripes only.
+    void done(int start, int end) const
+    {
+        if (isStriped()) {
+            buffer.advise(MappedBuffer::Access::Done,
+                          static_cast<size_t>(start) * height * sizeof(T),
+                          static_cast<size_t>(end - start) * height * sizeof(T));
+        }
+    }
+
+private:
+    T *stripe(int x0) const { return buffer.data<T>() + static_cast<size_t>(x0) * height; }
+    int stripeCols(int x0) const { return std::min(stripeWidth, width - x0); }
+
+    MappedBuffer buffer;
+    int width;
+    int height;
+    int stripeWidth;
+};
+
+// If the tw x height tile at src (row stride srcStride) holds a single
+// value, writes it to the same tile of dst and returns true.
+template <typename T>
+bool fillUniformTile(const T *src, int srcStride, int height, int tw, T *dst, int dstStride)
+{
+    const T value = src[0];
+    for (int y = 0; y < height; ++y) {
+        const T *row = src + static_cast<size_t>(y) * srcStride;
+        for (int c = 0; c < tw; ++c) {
+            if (row[c] != value) {
+                return false;
+            }
+        }
+    }
+    for (int y = 0; y < height; ++y) {
+        std::fill_n(dst + static_cast<size_t>(y) * dstStride, tw, value);
+    }
+    return true;
+}
+
+// Keeps column blocks on tile boundaries so that neighbouring workers never
+// write into the same cache line of the output.
+int columnBlockSize(int width, int tileWidth)
+{
+    const int blockSize = chooseBlockSize(width);
+    return ((blockSize + tileWidth - 1) / tileWidth) * tileWidth;
+}
+
+// rowInput(y, scratch) returns the width input values of row y, either in
+// place or written to scratch. out receives width * height values; returns
+// false if canceled.
+template <typename T, typename RowInputFn>
+bool transform2D(
+    const RowInputFn &rowInput,
+    int width,
+    int height,
+    T *out,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    const auto report = [&](int delta) {
+        if (progressFn) {
+            progressFn(delta);
+        }
+    };
+
+    constexpr int tileWidth = columnTileWidth<T>();
+    const int colBlockSize = columnBlockSize(width, tileWidth);
+    const RowPassBuffer<T> tmp(width, height, colBlockSize);
+
+    const auto rowBlock = [&](int start, int end) {
+        ScratchArena &arena = ScratchArena::local();
+        T *scratch = arena.get<T>(ScratchArena::LineInput, width);
+        T *line = tmp.isStriped() ? arena.get<T>(ScratchArena::LineOutput, width) : nullptr;
+        PassSkipStats counts;
+        for (int y = start; y < end; ++y) {
+            if (cancel && cancel->load()) {
+                return;
+            }
+            T *rowOut = line ? line : tmp.row(y);
+            countLine(counts, width, transformLine(rowInput(y, scratch), width, rowOut));
+            if (line) {
+                tmp.storeRow(y, line);
+            }
+        }
+        detail::recordPassSkips(false, counts);
+    };
+
+    const int rowBlockSize = chooseBlockSize(height);
+    if (!runParallelBlocks(height, rowBlockSize, cancel, rowBlock, report)) {
+        return false;
+    }
+
+    // Columns are processed in tiles: a tile is transposed into contiguous
+    // scratch, transformed column by column and transposed back, so global
+    // memory is only touched with row-contiguous runs of tileWidth values.
+    // A tile whose values are all equal is its own result and skips the
+    // transposes as well.
+    const auto colBlock = [&](int start, int end) {
+        ScratchArena &arena = ScratchArena::local();
+        T *colIn = arena.get<T>(ScratchArena::LineInput, static_cast<size_t>(tileWidth) * height);
+        T *colOut = arena.get<T>(ScratchArena::LineOutput, static_cast<size_t>(tileWidth) * height);
+        PassSkipStats counts;
+        std::uint64_t tiles = 0;
+        std::uint64_t uniformTiles = 0;
+        for (int x0 = start; x0 < end; x0 += tileWidth) {
+            if (cancel && cancel->load()) {
+                return;
+            }
+            const int tw = std::min(tileWidth, end - x0);
+            ++tiles;
+            if (fillUniformTile(tmp.column(x0), tmp.columnStride(x0), height, tw, out + x0, width)) {
+                ++uniformTiles;
+                for (int c = 0; c < tw; ++c) {
+                    countLine(counts, height, height);
+                }
+                continue;
+            }
+            transposeTileToColumns(tmp.column(x0), tmp.columnStride(x0), height, tw, colIn);
+            for (int c = 0; c < tw; ++c) {
+                const size_t colOffset = static_cast<size_t>(c) * height;
+                countLine(counts, height, transformLine(colIn + colOffset, height, colOut + colOffset));
+            }
+            transposeColumnsToTile(colOut, width, height, tw, out + x0);
+        }
+        tmp.done(start, end);
+        detail::recordPassSkips(true, counts);
+        detail::recordTileSkips(tiles, uniformTiles);
+    };
+
+    return runParallelBlocks(width, colBlockSize, cancel, colBlock, report);
+}
+
+// The fused transform over either mask type. oppositeRow(y, d) writes the
+// row pass of row y and returns true for a row of one class;
+// unpackTile(y, x0, tw, line) writes the 0 / 1 classes of tw pixels.
+template <typename OppositeRowFn, typename UnpackTileFn>
+bool signedTransform2D(
+    int width,
+    int height,
+    const OppositeRowFn &oppositeRow,
+    const UnpackTileFn &unpackTile,
+    SquaredDistance *out,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    // One pass stands in for the two fields of the unfused transform.
+    const auto report = [&](int delta) {
+        if (progressFn) {
+            progressFn(2 * delta);
+        }
+    };
+
+    constexpr int tileWidth = columnTileWidth<SquaredDistance>();
+    const int colBlockSize = columnBlockSize(width, tileWidth);
+    const RowPassBuffer<SquaredDistance> tmp(width, height, colBlockSize);
+
+    const auto rowBlock = [&](int start, int end) {
+        SquaredDistance *line = tmp.isStriped()
+            ? ScratchArena::local().get<SquaredDistance>(ScratchArena::LineOutput, width)
+            : nullptr;
+        PassSkipStats counts;
+        for (int y = start; y < end; ++y) {
+            if (cancel && cancel->load()) {
+                return;
+            }
+            const bool uniform = oppositeRow(y, line ? line : tmp.row(y));
+            countLine(counts, width, uniform ? width : 0);
+            if (line) {
+                tmp.storeRow(y, line);
+            }
+        }
+        detail::recordPassSkips(false, counts);
+    };
+
+    if (!runParallelBlocks(height, chooseBlockSize(height), cancel, rowBlock, report)) {
+        return false;
+    }
+
+    const auto colBlock = [&](int start, int end) {
+        ScratchArena &arena = ScratchArena::local();
+        const size_t tileSize = static_cast<size_t>(tileWidth) * height;
+        SquaredDistance *colIn = arena.get<SquaredDistance>(ScratchArena::LineInput, tileSize);
+        SquaredDistance *colOut = arena.get<SquaredDistance>(ScratchArena::LineOutput, tileSize);
+        std::uint8_t *colMask = arena.get<std::uint8_t>(ScratchArena::TileColumn, tileSize + tileWidth);
+        std::uint8_t *tileLine = colMask + tileSize;
+        PassSkipStats counts;
+        for (int x0 = start; x0 < end; x0 += tileWidth) {
+            if (cancel && cancel->load()) {
+                return;
+            }
+            const int tw = std::min(tileWidth, end - x0);
+            transposeTileToColumns(tmp.column(x0), tmp.columnStride(x0), height, tw, colIn);
+            for (int y = 0; y < height; ++y) {
+                unpackTile(y, x0, tw, tileLine);
+                for (int c = 0; c < tw; ++c) {
+                    colMask[static_cast<size_t>(c) * height + y] = tileLine[c];
+                }
+            }
+            for (int c = 0; c < tw; ++c) {
+                const size_t colOffset = static_cast<size_t>(c) * height;
+                signedColumn1D(colIn + colOffset, colMask + colOffset, height, colOut + colOffset, counts);
+            }
+            transposeColumnsToTile(colOut, width, height, tw, out + x0);
+        }
+        tmp.done(start, end);
+        detail::recordPassSkips(true, counts);
+    };
+
+    return runParallelBlocks(width, colBlockSize, cancel, colBlock, report);
+}
+
+// The fused transform of either mask type into out.
+bool signedMaskTransform(
+    const BitMask &mask,
+    SquaredDistance *out,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    const auto oppositeRow = [&](int y, SquaredDistance *d) {
+        return oppositeRowDistances(mask.row(y), mask.width(), d);
+    };
+    const auto unpackTile = [&](int y, int x0, int tw, std::uint8_t *line) {
+        const BitMask::Word *bits = mask.row(y);
+        for (int c = 0; c < tw; ++c) {
+            line[c] = BitMask::bitAt(bits, x0 + c) ? 1 : 0;
+        }
+    };
+    return signedTransform2D(mask.width(), mask.height(), oppositeRow, unpackTile, out, cancel, progressFn);
+}
+
+bool signedMaskTransform(
+    const RunMask &mask,
+    SquaredDistance *out,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    const auto oppositeRow = [&](int y, SquaredDistance *d) {
+        return oppositeRowDistances(mask.rowEdges(y), mask.width(), d);
+    };
+    const auto unpackTile = [&](int y, int x0, int tw, std::uint8_t *line) {
+        mask.unpackRow(x0, y, Span<std::uint8_t>(line, static_cast<size_t>(tw)));
+    };
+    return signedTransform2D(mask.width(), mask.height(), oppositeRow, unpackTile, out, cancel, progressFn);
+}
+
+// distanceTransform2D of the mask into out.
+template <typename T>
+bool maskTransform(
+    const BitMask &mask,
+    bool seedInside,
+    T *out,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    constexpr T inf = kInfinityValue<T>;
+    const int width = mask.width();
+    const auto rowInput = [&](int y, T *scratch) {
+        const BitMask::Word *bits = mask.row(y);
+        for (int start = 0; start < width;) {
+            const bool inside = BitMask::bitAt(bits, start);
+            const int end = BitMask::findChange(bits, width, start, inside);
+            std::fill(scratch + start, scratch + end, inside == seedInside ? T(0) : inf);
+            start = end;
+        }
+        return static_cast<const T *>(scratch);
+    };
+    return transform2D<T>(rowInput, width, mask.height(), out, cancel, progressFn);
+}
+
+// A new field of count values of T filled by transform(out); empty if the
+// transform fails.
+template <typename T, typename TransformFn>
+std::vector<T> vectorField(size_t count, const TransformFn &transform)
+{
+    std::vector<T> field(count);
+    if (!transform(field.data())) {
+        return {};
+    }
+    return field;
+}
+
+template <typename T, typename TransformFn>
+MappedBuffer mappedField(size_t count, const TransformFn &transform)
+{
+    MappedBuffer field(count * sizeof(T));
+    if (!transform(field.data<T>())) {
+        return MappedBuffer();
+    }
+    return field;
+}
+
+template <typename Mask>
+size_t pixelCount(const Mask &mask)
+{
+    return static_cast<size_t>(mask.width()) * mask.height();
+}
+
+} // namespace
+
+std::vector<SquaredDistance> signedDistanceTransform2D(
+    const BitMask &mask,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (mask.isNull()) {
+        return {};
+    }
+    return vectorField<SquaredDistance>(pixelCount(mask), [&](SquaredDistance *out) {
+        return signedMaskTransform(mask, out, cancel, progressFn);
+    });
+}
+
+std::vector<SquaredDistance> signedDistanceTransform2D(
+    const RunMask &mask,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (mask.isNull()) {
+        return {};
+    }
+    return vectorField<SquaredDistance>(pixelCount(mask), [&](SquaredDistance *out) {
+        return signedMaskTransform(mask, out, cancel, progressFn);
+    });
+}
+
+MappedBuffer mappedSignedDistanceTransform2D(
+    const BitMask &mask,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (mask.isNull()) {
+        return MappedBuffer();
+    }
+    return mappedField<SquaredDistance>(pixelCount(mask), [&](SquaredDistance *out) {
+        return signedMaskTransform(mask, out, cancel, progressFn);
+    });
+}
+
+MappedBuffer mappedSignedDistanceTransform2D(
+    const RunMask &mask,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (mask.isNull()) {
+        return MappedBuffer();
+    }
+    return mappedField<SquaredDistance>(pixelCount(mask), [&](SquaredDistance *out) {
+        return signedMaskTransform(mask, out, cancel, progressFn);
+    });
+}
+
+template <typename T>
+std::vector<T> distanceTransform2D(
+    Span<const T> f,
+    int width,
+    int height,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (width <= 0 || height <= 0 || f.size() != static_cast<size_t>(width) * height) {
+        return {};
+    }
+
+    const auto rowInput = [&](int y, T *) {
+        return f.data() + static_cast<size_t>(y) * width;
+    };
+    return vectorField<T>(f.size(), [&](T *out) {
+        return transform2D<T>(rowInput, width, height, out, cancel, progressFn);
+    });
+}
+
+template <typename T>
+std::vector<T> distanceTransform2D(
+    const BitMask &mask,
+    bool seedInside,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (mask.isNull()) {
+        return {};
+    }
+    return vectorField<T>(pixelCount(mask), [&](T *out) {
+        return maskTransform<T>(mask, seedInside, out, cancel, progressFn);
+    });
+}
+
+template <typename T>
+MappedBuffer mappedDistanceTransform2D(
+    const BitMask &mask,
+    bool seedInside,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (mask.isNull()) {
+        return MappedBuffer();
+    }
+    return mappedField<T>(pixelCount(mask), [&](T *out) {
+        return maskTransform<T>(mask, seedInside, out, cancel, progressFn);
+    });
+}
+
+template void distanceTransform1D<float>(Span<const float>, Span<float>);
+template void distanceTransform1D<double>(Span<const double>, Span<double>);
+template std::vector<float> distanceTransform2D<float>(
+    Span<const float>, int, int, std::atomic_bool *, const ProgressFn &);
+template std::vector<double> distanceTransform2D<double>(
+    Span<const double>, int, int, std::atomic_bool *, const ProgressFn &);
+template std::vector<SquaredDistance> distanceTransform2D<SquaredDistance>(
+    Span<const SquaredDistance>, int, int, std::atomic_bool *, const ProgressFn &);
+template std::vector<float> distanceTransform2D<float>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+template std::vector<double> distanceTransform2D<double>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+template std::vector<SquaredDistance> distanceTransform2D<SquaredDistance>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+template MappedBuffer mappedDistanceTransform2D<float>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+template MappedBuffer mappedDistanceTransform2D<double>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+template MappedBuffer mappedDistanceTransform2D<SquaredDistance>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+
+} // namespace sdf
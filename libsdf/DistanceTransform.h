@@ -0,0 +1,177 @@
+#ifndef SDF_DISTANCETRANSFORM_H
+#define SDF_DISTANCETRANSFORM_H
+
+#include "BitMask.h"
+#include "MappedBuffer.h"
+#include "Parallel.h"
+#include "RunMask.h"
+#include "Span.h"
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace sdf {
+
+// Value type the transforms run in. Exact keeps integer squared distances
+// in uint32 and is only meaningful for binary (0 / infinity) seeds. Auto
+// picks Exact for binary input, otherwise Float for 8-bit output, where
+// double precision cannot change the quantized result. Float squares are
+// exact only up to 4096 pixels per side; where the uint32 Exact range does
+// not reach, the generators run Exact requests in Double.
+enum class Precision
+{
+    Auto,
+    Float,
+    Double,
+    Exact,
+};
+
+Precision resolvePrecision(Precision requested, bool binaryInput, bool eightBitOutput);
+
+using SquaredDistance = std::uint32_t;
+
+template <typename T>
+constexpr T kInfinityValue = static_cast<T>(1e20);
+
+// Larger than any squared distance on a grid up to 46340 pixels per side;
+// longer exact distances saturate to it.
+template <>
+constexpr SquaredDistance kInfinityValue<SquaredDistance> = std::numeric_limits<SquaredDistance>::max();
+
+constexpr double kInfinity = kInfinityValue<double>;
+
+// Felzenszwalb/Huttenlocher 1D squared distance transform of the sampled
+// function f >= 0. d must hold at least f.size() elements. A constant f is
+// copied through; otherwise only samples that can be nearest to another
+// sample enter the envelope, so infinite samples and seeds (0) inside a run
+// of seeds cost a comparison each. The SquaredDistance version intersects
+// parabolas with exact integer floor division and saturates at
+// kInfinityValue.
+template <typename T>
+void distanceTransform1D(Span<const T> f, Span<T> d);
+
+// Separable 2D squared distance transform of a width x height row-major grid.
+// Seeds are 0, everything else kInfinityValue<T>. Returns an empty vector on
+// invalid input or cancellation. progressFn receives height + width units.
+// The row-pass intermediate is a MappedBuffer; once file-backed
+// (mappedScratchConfig()) its stripes are dropped as the column pass
+// finishes them. The returned field is on the heap, see
+// mappedDistanceTransform2D() for one that is not.
+template <typename T>
+std::vector<T> distanceTransform2D(
+    Span<const T> f,
+    int width,
+    int height,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// distanceTransform2D seeded straight from a mask: seeds are the pixels whose
+// bit equals seedInside, no input grid is allocated.
+template <typename T>
+std::vector<T> distanceTransform2D(
+    const BitMask &mask,
+    bool seedInside,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// Exact squared distance from every pixel of the mask to the nearest pixel
+// of the other class: the inside and outside fields of
+// distanceTransform2D<SquaredDistance> fused into one row pass and one column
+// pass, with identical results. The row pass walks runs of equal pixels a
+// word at a time. progressFn receives 2 * (height + width) units, the same
+// as two distanceTransform2D runs.
+std::vector<SquaredDistance> signedDistanceTransform2D(
+    const BitMask &mask,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// The same transform from a run-length mask: the row pass reads each row's
+// runs directly instead of scanning its width.
+std::vector<SquaredDistance> signedDistanceTransform2D(
+    const RunMask &mask,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// The mask transforms above with the field returned in a MappedBuffer of
+// width * height values, file-backed under the same mappedScratchConfig()
+// as the row-pass intermediate: with file backing, a job keeps no
+// full-size field on the heap. An empty buffer on invalid input or
+// cancellation.
+template <typename T>
+MappedBuffer mappedDistanceTransform2D(
+    const BitMask &mask,
+    bool seedInside,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+MappedBuffer mappedSignedDistanceTransform2D(
+    const BitMask &mask,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+MappedBuffer mappedSignedDistanceTransform2D(
+    const RunMask &mask,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// Work the transforms skipped on uniform data, accumulated over every run
+// since the last resetSkipStats(). A pass counts its lines (rows or
+// columns; both fields of a line for the fused transform) and their
+// samples; uniform lines are copied or filled without an envelope, and
+// skippedSamples also counts the samples those lines and the envelope
+// filter left out. Tiles are column tiles of the full transforms and
+// narrow band tiles; uniform ones are filled directly.
+struct PassSkipStats
+{
+    std::uint64_t lines = 0;
+    std::uint64_t uniformLines = 0;
+    std::uint64_t samples = 0;
+    std::uint64_t skippedSamples = 0;
+};
+
+struct SkipStats
+{
+    PassSkipStats rowPass;
+    PassSkipStats columnPass;
+    std::uint64_t tiles = 0;
+    std::uint64_t uniformTiles = 0;
+};
+
+SkipStats skipStats();
+void resetSkipStats();
+
+namespace detail {
+
+void recordPassSkips(bool columnPass, const PassSkipStats &counts);
+void recordTileSkips(std::uint64_t tiles, std::uint64_t uniformTiles);
+
+} // namespace detail
+
+extern template void distanceTransform1D<float>(Span<const float>, Span<float>);
+extern template void distanceTransform1D<double>(Span<const double>, Span<double>);
+template <>
+void distanceTransform1D<SquaredDistance>(Span<const SquaredDistance> f, Span<SquaredDistance> d);
+extern template std::vector<float> distanceTransform2D<float>(
+    Span<const float>, int, int, std::atomic_bool *, const ProgressFn &);
+extern template std::vector<double> distanceTransform2D<double>(
+    Span<const double>, int, int, std::atomic_bool *, const ProgressFn &);
+extern template std::vector<SquaredDistance> distanceTransform2D<SquaredDistance>(
+    Span<const SquaredDistance>, int, int, std::atomic_bool *, const ProgressFn &);
+extern template std::vector<float> distanceTransform2D<float>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+extern template std::vector<double> distanceTransform2D<double>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+extern template std::vector<SquaredDistance> distanceTransform2D<SquaredDistance>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+extern template MappedBuffer mappedDistanceTransform2D<float>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+extern template MappedBuffer mappedDistanceTransform2D<double>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+extern template MappedBuffer mappedDistanceTransform2D<SquaredDistance>(
+    const BitMask &, bool, std::atomic_bool *, const ProgressFn &);
+
+} // namespace sdf
+
+#endif // SDF_DISTANCETRANSFORM_H
@@ -0,0 +1,27 @@
+#ifndef SDF_IMAGEVIEW_H
+#define SDF_IMAGEVIEW_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sdf {
+
+// Non-owning view of a row-major 2D image. stride is in elements.
+template <typename T>
+struct ImageView
+{
+    T *data = nullptr;
+    int width = 0;
+    int height = 0;
+    std::ptrdiff_t stride = 0;
+
+    T *row(int y) const { return data + y * stride; }
+    bool isNull() const { return data == nullptr || width <= 0 || height <= 0; }
+};
+
+using GrayImageView = ImageView<const std::uint8_t>;
+using OutputImageView = ImageView<std::uint8_t>;
+
+} // namespace sdf
+
+#endif // SDF_IMAGEVIEW_H
@@ -0,0 +1,165 @@
+#include "MappedBuffer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#define SDF_HAVE_MMAP 1
+#endif
+
+namespace sdf {
+
+namespace {
+
+constexpr std::size_t kHeapAlignment = 64;
+
+std::mutex configMutex;
+MappedScratchConfig currentConfig;
+
+#if defined(SDF_HAVE_MMAP)
+// Maps a fresh temporary file of the given size, or returns nullptr. The
+// file is unlinked right away, so its blocks go back to the file system
+// when the mapping is released, even after a crash.
+void *mapScratchFile(const std::string &directory, std::size_t bytes)
+{
+    std::string dir = directory;
+    if (dir.empty()) {
+        const char *tmp = std::getenv("TMPDIR");
+        dir = tmp && *tmp ? tmp : "/tmp";
+    }
+    std::string path = dir + "/sdf-scratch-XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+    const int fd = mkstemp(name.data());
+    if (fd < 0) {
+        return nullptr;
+    }
+    unlink(name.data());
+    void *base = nullptr;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+        base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            base = nullptr;
+        }
+    }
+    close(fd);
+    return base;
+}
+#endif
+
+} // namespace
+
+void setMappedScratchConfig(const MappedScratchConfig &config)
+{
+    std::lock_guard<std::mutex> lock(configMutex);
+    currentConfig = config;
+}
+
+MappedScratchConfig mappedScratchConfig()
+{
+    std::lock_guard<std::mutex> lock(configMutex);
+    return currentConfig;
+}
+
+MappedBuffer::MappedBuffer(std::size_t size)
+    : bytes(size)
+{
+    if (size == 0) {
+        return;
+    }
+#if defined(SDF_HAVE_MMAP)
+    const MappedScratchConfig config = mappedScratchConfig();
+    if (config.minBytes > 0 && size >= config.minBytes) {
+        base = mapScratchFile(config.directory, size);
+        mapped = base != nullptr;
+    }
+#endif
+    if (!base) {
+        base = ::operator new(size, std::align_val_t(kHeapAlignment));
+    }
+}
+
+MappedBuffer::~MappedBuffer()
+{
+    release();
+}
+
+MappedBuffer::MappedBuffer(MappedBuffer &&other) noexcept
+    : base(std::exchange(other.base, nullptr))
+    , bytes(std::exchange(other.bytes, 0))
+    , mapped(std::exchange(other.mapped, false))
+{
+}
+
+MappedBuffer &MappedBuffer::operator=(MappedBuffer &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        base = std::exchange(other.base, nullptr);
+        bytes = std::exchange(other.bytes, 0);
+        mapped = std::exchange(other.mapped, false);
+    }
+    return *this;
+}
+
+void MappedBuffer::release()
+{
+    if (!base) {
+        return;
+    }
+#if defined(SDF_HAVE_MMAP)
+    if (mapped) {
+        munmap(base, bytes);
+        base = nullptr;
+        return;
+    }
+#endif
+    ::operator delete(base, std::align_val_t(kHeapAlignment));
+    base = nullptr;
+}
+
+void MappedBuffer::advise(Access access, std::size_t offset, std::size_t count) const
+{
+#if defined(SDF_HAVE_MMAP)
+    if (!mapped || count == 0) {
+        return;
+    }
+    // madvise wants a page-aligned start; Done only covers whole pages so
+    // that neighbouring data is never discarded.
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t begin = offset / page * page;
+    std::size_t end = std::min(bytes, offset + count);
+    if (access == Access::Done) {
+        begin = (offset + page - 1) / page * page;
+        end = end == bytes ? end : end / page * page;
+        if (end <= begin) {
+            return;
+        }
+    }
+    char *start = static_cast<char *>(base) + begin;
+    switch (access) {
+    case Access::Sequential:
+        madvise(start, end - begin, MADV_SEQUENTIAL);
+        break;
+    case Access::Done:
+#if defined(MADV_REMOVE)
+        madvise(start, end - begin, MADV_REMOVE);
+#else
+        madvise(start, end - begin, MADV_DONTNEED);
+#endif
+        break;
+    }
+#else
+    (void)access;
+    (void)offset;
+    (void)count;
+#endif
+}
+
+} // namespace sdf
@@ -0,0 +1,71 @@
+#ifndef SDF_MAPPEDBUFFER_H
+#define SDF_MAPPEDBUFFER_H
+
+#include <cstddef>
+#include <string>
+
+namespace sdf {
+
+// Where the whole-image intermediates and fields of the transforms live.
+// Buffers of at least minBytes are backed by an unlinked temporary file in
+// directory, mapped into memory, so that under memory pressure the kernel
+// writes them to that file instead of failing or swapping. minBytes = 0
+// keeps every buffer on the heap, as does any platform without mmap
+// (Windows).
+struct MappedScratchConfig
+{
+    // Empty: $TMPDIR, or /tmp.
+    std::string directory;
+    std::size_t minBytes = 0;
+};
+
+void setMappedScratchConfig(const MappedScratchConfig &config);
+MappedScratchConfig mappedScratchConfig();
+
+// Uninitialized, 64-byte aligned storage, file-backed according to
+// mappedScratchConfig() and on the heap otherwise (or if the file cannot be
+// created). Heap allocation failure throws std::bad_alloc.
+class MappedBuffer
+{
+public:
+    enum class Access
+    {
+        // Read or written front to back; enables aggressive read-ahead.
+        Sequential,
+        // Contents no longer needed; the pages are released without being
+        // written back.
+        Done,
+    };
+
+    MappedBuffer() = default;
+    explicit MappedBuffer(std::size_t bytes);
+    ~MappedBuffer();
+
+    MappedBuffer(MappedBuffer &&other) noexcept;
+    MappedBuffer &operator=(MappedBuffer &&other) noexcept;
+    MappedBuffer(const MappedBuffer &) = delete;
+    MappedBuffer &operator=(const MappedBuffer &) = delete;
+
+    template <typename T>
+    T *data() const
+    {
+        return static_cast<T *>(base);
+    }
+
+    std::size_t size() const { return bytes; }
+    bool isMapped() const { return mapped; }
+
+    // Hint for the bytes [offset, offset + count); ignored for heap buffers.
+    void advise(Access access, std::size_t offset, std::size_t count) const;
+
+private:
+    void release();
+
+    void *base = nullptr;
+    std::size_t bytes = 0;
+    bool mapped = false;
+};
+
+} // namespace sdf
+
+#endif // SDF_MAPPEDBUFFER_H
@@ -0,0 +1,190 @@
+#include "Meijster.h"
+
+#include "ScratchArena.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SDF_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace sdf {
+
+namespace {
+
+// Vertical distance used for columns without any seed. Small enough that
+// g * g fits comfortably in 64 bits and that g + height stays in int32,
+// large enough that it can never win against a real seed in phase 2.
+constexpr std::int32_t kNoSeed = 1 << 30;
+constexpr std::int64_t kNoSeedSq = static_cast<std::int64_t>(kNoSeed) * kNoSeed;
+
+// Columns per phase 1 strip: a multiple of the SIMD width that keeps a
+// strip's rows in whole cache lines and starts on a mask word.
+constexpr int kStripWidth = 64;
+
+// g[y][x] = 0 at seeds, otherwise g[y - 1][x] + 1. bits is the mask row
+// starting at a word boundary.
+void forwardRow(const BitMask::Word *bits, const std::int32_t *prev, std::int32_t *g, int count, bool seedInside)
+{
+    int x = 0;
+#ifdef SDF_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i laneBits = _mm_set_epi32(8, 4, 2, 1);
+    const __m128i invert = seedInside ? _mm_set1_epi32(-1) : zero;
+    for (; x + 4 <= count; x += 4) {
+        const auto nibble = static_cast<int>((bits[x / BitMask::kWordBits] >> (x % BitMask::kWordBits)) & 0xF);
+        const __m128i lanes = _mm_and_si128(_mm_set1_epi32(nibble), laneBits);
+        // All ones where the pixel is a seed.
+        const __m128i seed = _mm_xor_si128(_mm_cmpeq_epi32(lanes, zero), invert);
+        const __m128i above = prev
+            ? _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(prev + x)), one)
+            : _mm_set1_epi32(kNoSeed);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(g + x), _mm_andnot_si128(seed, above));
+    }
+#endif
+    for (; x < count; ++x) {
+        const bool seed = BitMask::bitAt(bits, x) == seedInside;
+        const std::int32_t above = prev ? prev[x] + 1 : kNoSeed;
+        g[x] = seed ? 0 : above;
+    }
+}
+
+// g[y][x] = min(g[y][x], g[y + 1][x] + 1).
+void backwardRow(const std::int32_t *next, std::int32_t *g, int count)
+{
+    int x = 0;
+#ifdef SDF_HAVE_SSE2
+    const __m128i one = _mm_set1_epi32(1);
+    for (; x + 4 <= count; x += 4) {
+        const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i *>(g + x));
+        const __m128i below = _mm_add_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(next + x)), one);
+        const __m128i takeBelow = _mm_cmpgt_epi32(current, below);
+        const __m128i result = _mm_or_si128(_mm_and_si128(takeBelow, below), _mm_andnot_si128(takeBelow, current));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(g + x), result);
+    }
+#endif
+    for (; x < count; ++x) {
+        g[x] = std::min(g[x], next[x] + 1);
+    }
+}
+
+inline std::int64_t gSquared(std::int32_t g)
+{
+    return g >= kNoSeed ? kNoSeedSq : static_cast<std::int64_t>(g) * g;
+}
+
+// Phase 2 for one row: lower envelope of (x - i)^2 + g(i)^2 over i.
+void envelopeRow(const std::int32_t *g, SquaredDistance *d, int width)
+{
+    ScratchArena &arena = ScratchArena::local();
+    int *s = arena.get<int>(ScratchArena::EnvelopeSites, width);
+    int *t = arena.get<int>(ScratchArena::LineInput, width);
+    std::int64_t *gg = arena.get<std::int64_t>(ScratchArena::EnvelopeBounds, width);
+
+    for (int i = 0; i < width; ++i) {
+        gg[i] = gSquared(g[i]);
+    }
+    const auto f = [gg](int x, int i) -> std::int64_t {
+        const std::int64_t dx = x - i;
+        return dx * dx + gg[i];
+    };
+    const auto sep = [gg](int i, int u) -> std::int64_t {
+        const std::int64_t num = static_cast<std::int64_t>(u) * u - static_cast<std::int64_t>(i) * i + gg[u] - gg[i];
+        const std::int64_t den = 2 * static_cast<std::int64_t>(u - i);
+        return num >= 0 ? num / den : -((-num + den - 1) / den);
+    };
+
+    int q = 0;
+    s[0] = 0;
+    t[0] = 0;
+    for (int u = 1; u < width; ++u) {
+        while (q >= 0 && f(t[q], s[q]) > f(t[q], u)) {
+            --q;
+        }
+        if (q < 0) {
+            q = 0;
+            s[0] = u;
+        } else {
+            const std::int64_t w = 1 + sep(s[q], u);
+            if (w < width) {
+                ++q;
+                s[q] = u;
+                t[q] = static_cast<int>(w);
+            }
+        }
+    }
+
+    constexpr SquaredDistance inf = kInfinityValue<SquaredDistance>;
+    for (int u = width - 1; u >= 0; --u) {
+        const std::int64_t value = f(u, s[q]);
+        d[u] = value >= inf ? inf : static_cast<SquaredDistance>(value);
+        if (u == t[q]) {
+            --q;
+        }
+    }
+}
+
+} // namespace
+
+std::vector<SquaredDistance> meijsterDistanceTransform(
+    const BitMask &mask,
+    bool seedInside,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (mask.isNull()) {
+        return {};
+    }
+    const int width = mask.width();
+    const int height = mask.height();
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+
+    const auto report = [&](int delta) {
+        if (progressFn) {
+            progressFn(delta);
+        }
+    };
+
+    std::vector<std::int32_t> g(pixelCount);
+
+    const auto stripBlock = [&](int start, int end) {
+        const int count = end - start;
+        for (int y = 0; y < height; ++y) {
+            const size_t rowOffset = static_cast<size_t>(y) * width + start;
+            const std::int32_t *prev = y > 0 ? g.data() + rowOffset - width : nullptr;
+            const BitMask::Word *bits = mask.row(y) + start / BitMask::kWordBits;
+            forwardRow(bits, prev, g.data() + rowOffset, count, seedInside);
+        }
+        for (int y = height - 2; y >= 0; --y) {
+            const size_t rowOffset = static_cast<size_t>(y) * width + start;
+            backwardRow(g.data() + rowOffset + width, g.data() + rowOffset, count);
+        }
+    };
+
+    int stripBlockSize = chooseBlockSize(width);
+    stripBlockSize = ((stripBlockSize + kStripWidth - 1) / kStripWidth) * kStripWidth;
+    if (!runParallelBlocks(width, stripBlockSize, cancel, stripBlock, report)) {
+        return {};
+    }
+
+    std::vector<SquaredDistance> out(pixelCount);
+    const auto rowBlock = [&](int start, int end) {
+        for (int y = start; y < end; ++y) {
+            if (cancel && cancel->load()) {
+                return;
+            }
+            const size_t rowOffset = static_cast<size_t>(y) * width;
+            envelopeRow(g.data() + rowOffset, out.data() + rowOffset, width);
+        }
+    };
+
+    if (!runParallelBlocks(height, chooseBlockSize(height), cancel, rowBlock, report)) {
+        return {};
+    }
+
+    return out;
+}
+
+} // namespace sdf
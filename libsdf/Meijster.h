@@ -0,0 +1,28 @@
+#ifndef SDF_MEIJSTER_H
+#define SDF_MEIJSTER_H
+
+#include "BitMask.h"
+#include "DistanceTransform.h"
+#include "Parallel.h"
+
+#include <atomic>
+#include <vector>
+
+namespace sdf {
+
+// Meijster, Roerdink and Hesselink's linear-time exact EDT on a binary mask.
+// Seeds are the pixels whose bit equals seedInside; the result holds the
+// squared distance to the nearest seed, kInfinityValue<SquaredDistance> when
+// there is none. Phase 1 (vertical distances) scans down strips of columns
+// with SIMD lanes across columns; phase 2 builds the lower envelope of each
+// row with integer arithmetic. progressFn receives width + height units.
+// Returns an empty vector on invalid input or cancellation.
+std::vector<SquaredDistance> meijsterDistanceTransform(
+    const BitMask &mask,
+    bool seedInside,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+} // namespace sdf
+
+#endif // SDF_MEIJSTER_H
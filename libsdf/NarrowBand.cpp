@@ -0,0 +1,456 @@
+#include "NarrowBand.h"
+
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace sdf {
+
+namespace {
+
+constexpr std::uint8_t kHasInside = 1;
+constexpr std::uint8_t kHasOutside = 2;
+
+// Cell size of the coarse level of coarseToFineDistances().
+constexpr int kCoarseCell = 32;
+// Longest run of cell rows transformed as one tile; bounds the column
+// scratch of a tile to (32 * 32 + 2 * band) rows.
+constexpr int kMaxRunCells = 32;
+
+// Tiles of at least twice the band keep the window overhead bounded; the
+// upper limit bounds the per-thread column scratch for very wide bands.
+int bandTileSize(int band)
+{
+    const int size = ((2 * band + 31) / 32) * 32;
+    return std::clamp(size, 32, 256);
+}
+
+// Summed-area table over one flag of the tile grid.
+std::vector<int> tileFlagTable(const std::vector<std::uint8_t> &flags, int cols, int rows, std::uint8_t flag)
+{
+    std::vector<int> table(static_cast<size_t>(cols + 1) * (rows + 1), 0);
+    for (int ty = 0; ty < rows; ++ty) {
+        int rowSum = 0;
+        for (int tx = 0; tx < cols; ++tx) {
+            rowSum += (flags[static_cast<size_t>(ty) * cols + tx] & flag) ? 1 : 0;
+            table[static_cast<size_t>(ty + 1) * (cols + 1) + tx + 1] = table[static_cast<size_t>(ty) * (cols + 1) + tx + 1] + rowSum;
+        }
+    }
+    return table;
+}
+
+int tableSum(const std::vector<int> &table, int cols, int tx0, int ty0, int tx1, int ty1)
+{
+    const int stride = cols + 1;
+    return table[static_cast<size_t>(ty1) * stride + tx1] - table[static_cast<size_t>(ty0) * stride + tx1]
+        - table[static_cast<size_t>(ty1) * stride + tx0] + table[static_cast<size_t>(ty0) * stride + tx0];
+}
+
+// kHasInside / kHasOutside for every tileSize square of the grid covering
+// the mask, row-major. Returns false if canceled.
+bool classifyTiles(const BitMask &mask, int tileSize, std::atomic_bool *cancel, std::vector<std::uint8_t> &flags)
+{
+    const int cols = (mask.width() + tileSize - 1) / tileSize;
+    const int rows = (mask.height() + tileSize - 1) / tileSize;
+    const int tileCount = cols * rows;
+    flags.assign(static_cast<size_t>(tileCount), 0);
+    const auto classifyBlock = [&](int start, int end) {
+        for (int index = start; index < end; ++index) {
+            const int x0 = (index % cols) * tileSize;
+            const int y0 = (index / cols) * tileSize;
+            const int x1 = std::min(mask.width(), x0 + tileSize);
+            const int y1 = std::min(mask.height(), y0 + tileSize);
+            std::uint8_t tileFlags = 0;
+            for (int y = y0; y < y1 && tileFlags != (kHasInside | kHasOutside); ++y) {
+                if (!(tileFlags & kHasInside) && mask.rowHas(y, x0, x1, true)) {
+                    tileFlags |= kHasInside;
+                }
+                if (!(tileFlags & kHasOutside) && mask.rowHas(y, x0, x1, false)) {
+                    tileFlags |= kHasOutside;
+                }
+            }
+            flags[static_cast<size_t>(index)] = tileFlags;
+        }
+    };
+    return runParallelBlocks(tileCount, chooseBlockSize(tileCount), cancel, classifyBlock, [](int) {});
+}
+
+struct BandTile
+{
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+// tile grown by margin on every side, clipped to the mask.
+BandTile growTile(const BandTile &tile, int margin, const BitMask &mask)
+{
+    return BandTile{std::max(0, tile.x0 - margin), std::max(0, tile.y0 - margin),
+                    std::min(mask.width(), tile.x1 + margin), std::min(mask.height(), tile.y1 + margin)};
+}
+
+// Exact clamped distances for one tile, written to tileSq (the value of
+// pixel (tile.x0, tile.y0), rows stride values apart). Horizontal distances
+// to the nearest inside/outside pixel are scanned over the window rows for
+// the tile columns only, stored column-major, and finished with the 1D
+// transform down each column of the window. The window must contain the
+// nearest opposite pixel of every tile pixel closer than band. Pixels whose
+// field is not needed have no opposite pixel in reach and get the clamp
+// value.
+void transformBandTile(
+    const BitMask &mask,
+    int band,
+    const BandTile &tile,
+    const BandTile &window,
+    bool needOutside,
+    bool needInside,
+    SquaredDistance *tileSq,
+    size_t stride)
+{
+    constexpr SquaredDistance inf = kInfinityValue<SquaredDistance>;
+    const SquaredDistance clampSq = static_cast<SquaredDistance>(band) * band;
+    const int wx0 = window.x0;
+    const int wx1 = window.x1;
+    const int wy0 = window.y0;
+    const int wy1 = window.y1;
+    const int tileW = tile.x1 - tile.x0;
+    const int windowH = wy1 - wy0;
+
+    for (int y = tile.y0; y < tile.y1; ++y) {
+        SquaredDistance *line = tileSq + static_cast<size_t>(y - tile.y0) * stride;
+        const BitMask::Word *bits = mask.row(y);
+        for (int x = tile.x0; x < tile.x1; ++x) {
+            const bool inside = BitMask::bitAt(bits, x);
+            if ((inside && !needOutside) || (!inside && !needInside)) {
+                line[x - tile.x0] = clampSq;
+            }
+        }
+    }
+    if (!needOutside && !needInside) {
+        return;
+    }
+
+    ScratchArena &arena = ScratchArena::local();
+    const size_t columnValues = static_cast<size_t>(tileW) * windowH;
+    SquaredDistance *toOutside = arena.get<SquaredDistance>(ScratchArena::LineInput, columnValues);
+    SquaredDistance *toInside = arena.get<SquaredDistance>(ScratchArena::LineOutput, columnValues);
+    SquaredDistance *column = arena.get<SquaredDistance>(ScratchArena::TileColumn, windowH);
+
+    const auto horizontal = [band, inf](int gap) -> SquaredDistance {
+        return gap > band ? inf : static_cast<SquaredDistance>(gap) * gap;
+    };
+
+    for (int yy = wy0; yy < wy1; ++yy) {
+        const BitMask::Word *row = mask.row(yy);
+        const size_t rowIndex = static_cast<size_t>(yy - wy0);
+        constexpr int kFar = 1 << 30;
+        int lastInside = -kFar;
+        int lastOutside = -kFar;
+        for (int x = wx0; x < tile.x1; ++x) {
+            if (BitMask::bitAt(row, x)) {
+                lastInside = x;
+            } else {
+                lastOutside = x;
+            }
+            if (x >= tile.x0) {
+                const size_t index = static_cast<size_t>(x - tile.x0) * windowH + rowIndex;
+                toOutside[index] = horizontal(std::min(x - lastOutside, kFar));
+                toInside[index] = horizontal(std::min(x - lastInside, kFar));
+            }
+        }
+        int nextInside = kFar;
+        int nextOutside = kFar;
+        for (int x = wx1 - 1; x >= tile.x0; --x) {
+            if (BitMask::bitAt(row, x)) {
+                nextInside = x;
+            } else {
+                nextOutside = x;
+            }
+            if (x < tile.x1) {
+                const size_t index = static_cast<size_t>(x - tile.x0) * windowH + rowIndex;
+                toOutside[index] = std::min(toOutside[index], horizontal(std::min(nextOutside - x, kFar)));
+                toInside[index] = std::min(toInside[index], horizontal(std::min(nextInside - x, kFar)));
+            }
+        }
+    }
+
+    for (int c = 0; c < tileW; ++c) {
+        const int x = tile.x0 + c;
+        const size_t columnOffset = static_cast<size_t>(c) * windowH;
+        for (int pass = 0; pass < 2; ++pass) {
+            const bool outsidePass = pass == 0;
+            if ((outsidePass && !needOutside) || (!outsidePass && !needInside)) {
+                continue;
+            }
+            const SquaredDistance *field = (outsidePass ? toOutside : toInside) + columnOffset;
+            distanceTransform1D<SquaredDistance>(
+                Span<const SquaredDistance>(field, windowH),
+                Span<SquaredDistance>(column, windowH));
+            for (int y = tile.y0; y < tile.y1; ++y) {
+                // Inside pixels measure to the outside field and vice versa.
+                if (mask.get(x, y) == outsidePass) {
+                    tileSq[static_cast<size_t>(y - tile.y0) * stride + c] = std::min(column[y - wy0], clampSq);
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+void narrowBandRect(
+    const BitMask &mask,
+    int band,
+    int x0,
+    int y0,
+    int x1,
+    int y1,
+    SquaredDistance *oppositeSq,
+    size_t stride)
+{
+    const BandTile tile{x0, y0, x1, y1};
+    const BandTile window = growTile(tile, band, mask);
+    const int wx0 = window.x0;
+    const int wx1 = window.x1;
+    const int wy0 = window.y0;
+    const int wy1 = window.y1;
+    bool tileInside = false;
+    bool tileOutside = false;
+    for (int y = y0; y < y1 && !(tileInside && tileOutside); ++y) {
+        tileInside = tileInside || mask.rowHas(y, x0, x1, true);
+        tileOutside = tileOutside || mask.rowHas(y, x0, x1, false);
+    }
+    bool windowInside = tileInside;
+    bool windowOutside = tileOutside;
+    for (int y = wy0; y < wy1 && !(windowInside && windowOutside); ++y) {
+        windowInside = windowInside || mask.rowHas(y, wx0, wx1, true);
+        windowOutside = windowOutside || mask.rowHas(y, wx0, wx1, false);
+    }
+    const bool needOutside = tileInside && windowOutside;
+    const bool needInside = tileOutside && windowInside;
+    transformBandTile(mask, band, tile, window, needOutside, needInside, oppositeSq, stride);
+    detail::recordTileSkips(1, needOutside || needInside ? 0 : 1);
+}
+
+bool narrowBandDistances(
+    const BitMask &mask,
+    int band,
+    Span<SquaredDistance> oppositeSq,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    const int width = mask.width();
+    const int height = mask.height();
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    if (mask.isNull() || band <= 0 || oppositeSq.size() < pixelCount) {
+        return false;
+    }
+
+    const int tileSize = bandTileSize(band);
+    const int cols = (width + tileSize - 1) / tileSize;
+    const int rows = (height + tileSize - 1) / tileSize;
+    const int tileCount = cols * rows;
+    const auto tileAt = [&](int index) {
+        const int tx = index % cols;
+        const int ty = index / cols;
+        BandTile tile;
+        tile.x0 = tx * tileSize;
+        tile.y0 = ty * tileSize;
+        tile.x1 = std::min(width, tile.x0 + tileSize);
+        tile.y1 = std::min(height, tile.y0 + tileSize);
+        return tile;
+    };
+
+    std::vector<std::uint8_t> flags;
+    if (!classifyTiles(mask, tileSize, cancel, flags)) {
+        return false;
+    }
+
+    const std::vector<int> insideTable = tileFlagTable(flags, cols, rows, kHasInside);
+    const std::vector<int> outsideTable = tileFlagTable(flags, cols, rows, kHasOutside);
+    const int radius = (band - 1) / tileSize + 1;
+
+    const auto tileBlock = [&](int start, int end) {
+        std::uint64_t uniformTiles = 0;
+        for (int index = start; index < end; ++index) {
+            if (cancel && cancel->load()) {
+                return;
+            }
+            const BandTile tile = tileAt(index);
+            const int tx = index % cols;
+            const int ty = index / cols;
+            const int tx0 = std::max(0, tx - radius);
+            const int ty0 = std::max(0, ty - radius);
+            const int tx1 = std::min(cols, tx + radius + 1);
+            const int ty1 = std::min(rows, ty + radius + 1);
+            const std::uint8_t tileFlags = flags[static_cast<size_t>(index)];
+            const bool needOutside = (tileFlags & kHasInside) && tableSum(outsideTable, cols, tx0, ty0, tx1, ty1) > 0;
+            const bool needInside = (tileFlags & kHasOutside) && tableSum(insideTable, cols, tx0, ty0, tx1, ty1) > 0;
+            SquaredDistance *tileSq = oppositeSq.data() + static_cast<size_t>(tile.y0) * width + tile.x0;
+            transformBandTile(mask, band, tile, growTile(tile, band, mask), needOutside, needInside, tileSq,
+                              static_cast<size_t>(width));
+            uniformTiles += needOutside || needInside ? 0 : 1;
+        }
+        detail::recordTileSkips(static_cast<std::uint64_t>(end - start), uniformTiles);
+    };
+
+    const int totalUnits = 2 * (width + height);
+    int tilesDone = 0;
+    int unitsReported = 0;
+    const auto reportTiles = [&](int delta) {
+        tilesDone += delta;
+        const int units = static_cast<int>((static_cast<long long>(totalUnits) * tilesDone) / tileCount);
+        if (units > unitsReported && progressFn) {
+            progressFn(units - unitsReported);
+        }
+        unitsReported = std::max(unitsReported, units);
+    };
+
+    return runParallelBlocks(tileCount, 1, cancel, tileBlock, reportTiles);
+}
+
+bool coarseToFineDistances(
+    const BitMask &mask,
+    int band,
+    Span<SquaredDistance> oppositeSq,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    constexpr SquaredDistance inf = kInfinityValue<SquaredDistance>;
+    const int width = mask.width();
+    const int height = mask.height();
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    if (mask.isNull() || band <= 0 || oppositeSq.size() < pixelCount) {
+        return false;
+    }
+    // A band under one cell already keeps every window within a cell of
+    // its tile; the coarse level has nothing to shrink.
+    if (band < kCoarseCell) {
+        return narrowBandDistances(mask, band, oppositeSq, cancel, progressFn);
+    }
+
+    // Coarse level: the classes each cell holds and, per class, the
+    // distance in cells to the nearest cell holding it.
+    std::vector<std::uint8_t> flags;
+    if (!classifyTiles(mask, kCoarseCell, cancel, flags)) {
+        return false;
+    }
+    const int cellCols = (width + kCoarseCell - 1) / kCoarseCell;
+    const int cellRows = (height + kCoarseCell - 1) / kCoarseCell;
+    const auto cellDistances = [&](std::uint8_t flag) {
+        std::vector<SquaredDistance> seeds(flags.size());
+        for (size_t i = 0; i < flags.size(); ++i) {
+            seeds[i] = (flags[i] & flag) ? 0 : inf;
+        }
+        return distanceTransform2D<SquaredDistance>(seeds, cellCols, cellRows, cancel, nullptr);
+    };
+    const std::vector<SquaredDistance> toInsideCells = cellDistances(kHasInside);
+    const std::vector<SquaredDistance> toOutsideCells = cellDistances(kHasOutside);
+    if (toInsideCells.empty() || toOutsideCells.empty()) {
+        return false;
+    }
+
+    // Every pixel of a cell D cells away from the nearest cell holding a
+    // class is between 32 * (D - sqrt 2) and 32 * (D + sqrt 2) from the
+    // nearest pixel of that class. The window margin a cell needs for that
+    // field is the upper bound, capped at band; 0 if the field is clamped
+    // throughout the cell.
+    const double sqrt2 = std::sqrt(2.0);
+    const auto fieldMargin = [&](SquaredDistance cellSq) {
+        if (cellSq == inf) {
+            return 0;
+        }
+        const double cells = std::sqrt(static_cast<double>(cellSq));
+        if (kCoarseCell * (cells - sqrt2) >= band) {
+            return 0;
+        }
+        return std::min(band, static_cast<int>(std::ceil(kCoarseCell * (cells + sqrt2))));
+    };
+
+    // Fine level: vertical strips, each cut into runs of cell rows that all
+    // need some field or all need none. A run is one tile, transformed over
+    // a window grown by its own cells' margins rather than by band.
+    struct CellRowNeed
+    {
+        int outsideMargin;
+        int insideMargin;
+    };
+    const int stripWidth = bandTileSize(band);
+    const int stripCount = (width + stripWidth - 1) / stripWidth;
+    const auto stripBlock = [&](int start, int end) {
+        std::vector<CellRowNeed> needs(static_cast<size_t>(cellRows));
+        std::uint64_t tiles = 0;
+        std::uint64_t uniformTiles = 0;
+        for (int strip = start; strip < end; ++strip) {
+            if (cancel && cancel->load()) {
+                return;
+            }
+            const int x0 = strip * stripWidth;
+            const int x1 = std::min(width, x0 + stripWidth);
+            for (int cy = 0; cy < cellRows; ++cy) {
+                CellRowNeed need{0, 0};
+                for (int cx = x0 / kCoarseCell; cx * kCoarseCell < x1; ++cx) {
+                    const size_t cell = static_cast<size_t>(cy) * cellCols + cx;
+                    if (flags[cell] & kHasInside) {
+                        need.outsideMargin = std::max(need.outsideMargin, fieldMargin(toOutsideCells[cell]));
+                    }
+                    if (flags[cell] & kHasOutside) {
+                        need.insideMargin = std::max(need.insideMargin, fieldMargin(toInsideCells[cell]));
+                    }
+                }
+                needs[static_cast<size_t>(cy)] = need;
+            }
+
+            const auto margin = [&](int cy) {
+                return std::max(needs[static_cast<size_t>(cy)].outsideMargin, needs[static_cast<size_t>(cy)].insideMargin);
+            };
+            for (int cy = 0; cy < cellRows;) {
+                const bool active = margin(cy) > 0;
+                bool needOutside = false;
+                bool needInside = false;
+                int maxMargin = 0;
+                int wy0 = height;
+                int wy1 = 0;
+                int cyEnd = cy;
+                while (cyEnd < cellRows && cyEnd - cy < kMaxRunCells && (margin(cyEnd) > 0) == active) {
+                    const CellRowNeed &need = needs[static_cast<size_t>(cyEnd)];
+                    needOutside = needOutside || need.outsideMargin > 0;
+                    needInside = needInside || need.insideMargin > 0;
+                    maxMargin = std::max(maxMargin, margin(cyEnd));
+                    wy0 = std::min(wy0, cyEnd * kCoarseCell - margin(cyEnd));
+                    wy1 = std::max(wy1, (cyEnd + 1) * kCoarseCell + margin(cyEnd));
+                    ++cyEnd;
+                }
+                const BandTile tile{x0, cy * kCoarseCell, x1, std::min(height, cyEnd * kCoarseCell)};
+                const BandTile window{std::max(0, x0 - maxMargin), std::max(0, wy0),
+                                      std::min(width, x1 + maxMargin), std::min(height, wy1)};
+                SquaredDistance *tileSq = oppositeSq.data() + static_cast<size_t>(tile.y0) * width + tile.x0;
+                transformBandTile(mask, band, tile, window, needOutside, needInside, tileSq,
+                                  static_cast<size_t>(width));
+                ++tiles;
+                uniformTiles += active ? 0 : 1;
+                cy = cyEnd;
+            }
+        }
+        detail::recordTileSkips(tiles, uniformTiles);
+    };
+
+    const int totalUnits = 2 * (width + height);
+    int stripsDone = 0;
+    int unitsReported = 0;
+    const auto reportStrips = [&](int delta) {
+        stripsDone += delta;
+        const int units = static_cast<int>((static_cast<long long>(totalUnits) * stripsDone) / stripCount);
+        if (units > unitsReported && progressFn) {
+            progressFn(units - unitsReported);
+        }
+        unitsReported = std::max(unitsReported, units);
+    };
+
+    return runParallelBlocks(stripCount, 1, cancel, stripBlock, reportStrips);
+}
+
+} // namespace sdf
@@ -0,0 +1,60 @@
+#ifndef SDF_NARROWBAND_H
+#define SDF_NARROWBAND_H
+
+#include "BitMask.h"
+#include "DistanceTransform.h"
+#include "Parallel.h"
+#include "Span.h"
+
+#include <atomic>
+#include <cstddef>
+
+namespace sdf {
+
+// Squared distance from every pixel of the mask to the nearest pixel of the
+// opposite value, clamped to band * band. The mask is split into tiles;
+// tiles with no opposite pixel within band are filled with the clamp value
+// and every other tile runs an exact transform over a window grown by band,
+// so the cost follows the length of the boundary rather than the image
+// area. Tiles are classified a mask word at a time. progressFn receives
+// 2 * (width + height) units, the same as two full distanceTransform2D runs.
+// Returns false on invalid input or cancellation.
+bool narrowBandDistances(
+    const BitMask &mask,
+    int band,
+    Span<SquaredDistance> oppositeSq,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// The same clamped distances computed coarse to fine. A coarse level of
+// 32 x 32 cells records which classes each cell holds, and an exact
+// transform over the cell grid bounds how far every cell is from each
+// class. Cells whose lower bound reaches band are filled with the clamp
+// value. The rest are transformed in vertical strips, over windows grown
+// by their upper bound instead of band, so cells close to the boundary
+// read only a few cells around them. Same result and progress units as
+// narrowBandDistances(), which it falls back to for bands under 32.
+bool coarseToFineDistances(
+    const BitMask &mask,
+    int band,
+    Span<SquaredDistance> oppositeSq,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// The same clamped distances for the pixels of [x0, x1) x [y0, y1) only,
+// reading just the part of the mask within band of the rectangle. Rows go
+// to oppositeSq stride values apart. Runs on the calling thread and uses its
+// scratch arena, so several rectangles can be computed concurrently.
+void narrowBandRect(
+    const BitMask &mask,
+    int band,
+    int x0,
+    int y0,
+    int x1,
+    int y1,
+    SquaredDistance *oppositeSq,
+    std::size_t stride);
+
+} // namespace sdf
+
+#endif // SDF_NARROWBAND_H
@@ -0,0 +1,66 @@
+#include "Parallel.h"
+
+namespace sdf {
+
+namespace {
+std::mutex statsMutex;
+ParallelStats statsTotals;
+} // namespace
+
+int effectiveThreadCount(int totalBlocks)
+{
+    return std::max(1, std::min(ThreadPool::shared().size(), totalBlocks));
+}
+
+int chooseBlockSize(int totalItems)
+{
+    if (totalItems <= 0) {
+        return 1;
+    }
+    // Fine enough that guided chunks and steals can still even out uneven
+    // rows near the end of a pass.
+    const int threads = effectiveThreadCount(totalItems);
+    int size = totalItems / (threads * 64);
+    if (size < 1) {
+        size = 1;
+    }
+    return size;
+}
+
+ParallelStats parallelStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return statsTotals;
+}
+
+void resetParallelStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    statsTotals = ParallelStats();
+}
+
+namespace detail {
+
+void recordWorkerStats(int worker, double busySeconds, std::uint64_t chunks, std::uint64_t steals)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    const size_t index = static_cast<size_t>(worker);
+    if (statsTotals.busySeconds.size() <= index) {
+        statsTotals.busySeconds.resize(index + 1, 0.0);
+        statsTotals.chunks.resize(index + 1, 0);
+        statsTotals.steals.resize(index + 1, 0);
+    }
+    statsTotals.busySeconds[index] += busySeconds;
+    statsTotals.chunks[index] += chunks;
+    statsTotals.steals[index] += steals;
+}
+
+void recordWallTime(double seconds)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    statsTotals.wallSeconds += seconds;
+}
+
+} // namespace detail
+
+} // namespace sdf
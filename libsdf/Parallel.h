@@ -0,0 +1,216 @@
+#ifndef SDF_PARALLEL_H
+#define SDF_PARALLEL_H
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sdf {
+
+using ProgressFn = std::function<void(int)>;
+
+int effectiveThreadCount(int totalBlocks);
+
+// Scheduling granularity for totalItems: chunks handed to workers are whole
+// multiples of this many items.
+int chooseBlockSize(int totalItems);
+
+// Per pool worker scheduling counters, accumulated over every
+// runParallelBlocks call since the last resetParallelStats().
+struct ParallelStats
+{
+    std::vector<double> busySeconds;
+    std::vector<std::uint64_t> chunks;
+    std::vector<std::uint64_t> steals;
+    double wallSeconds = 0.0;
+};
+
+ParallelStats parallelStats();
+void resetParallelStats();
+
+namespace detail {
+
+void recordWorkerStats(int worker, double busySeconds, std::uint64_t chunks, std::uint64_t steals);
+void recordWallTime(double seconds);
+
+// [begin, end) range of block indices owned by one worker, packed into one
+// word so the owner can pop from the front and thieves can split off the
+// back with a single compare-and-swap.
+struct alignas(64) WorkRange
+{
+    std::atomic<std::uint64_t> bounds{0};
+
+    static std::uint64_t pack(std::uint32_t begin, std::uint32_t end)
+    {
+        return (static_cast<std::uint64_t>(begin) << 32) | end;
+    }
+    static std::uint32_t begin(std::uint64_t bounds) { return static_cast<std::uint32_t>(bounds >> 32); }
+    static std::uint32_t end(std::uint64_t bounds) { return static_cast<std::uint32_t>(bounds); }
+};
+
+} // namespace detail
+
+// Splits [0, totalItems) into blocks of blockSize items and runs
+// blockFn(start, end) on the shared ThreadPool. Every worker starts with an
+// equal share of the blocks and takes guided chunks (a quarter of what it
+// has left) from the front of its share; idle workers steal the back half of
+// another worker's share. progressFn(delta) is invoked on the calling thread
+// with the number of newly completed items. Returns false if the run was
+// canceled. Calls made from inside a pool worker run their blocks inline.
+template <typename BlockFn, typename ProgressFnT>
+bool runParallelBlocks(
+    int totalItems,
+    int blockSize,
+    std::atomic_bool *cancel,
+    const BlockFn &blockFn,
+    const ProgressFnT &progressFn)
+{
+    using Clock = std::chrono::steady_clock;
+    using detail::WorkRange;
+
+    if (totalItems <= 0) {
+        return true;
+    }
+    if (blockSize <= 0) {
+        blockSize = chooseBlockSize(totalItems);
+    }
+
+    if (ThreadPool::isWorkerThread()) {
+        for (int start = 0; start < totalItems; start += blockSize) {
+            if (cancel && cancel->load()) {
+                return false;
+            }
+            const int end = std::min(start + blockSize, totalItems);
+            blockFn(start, end);
+            progressFn(end - start);
+        }
+        return !(cancel && cancel->load());
+    }
+
+    const Clock::time_point wallStart = Clock::now();
+    const int totalBlocks = (totalItems + blockSize - 1) / blockSize;
+    const int threadCount = effectiveThreadCount(totalBlocks);
+    std::unique_ptr<WorkRange[]> ranges(new WorkRange[threadCount]);
+    for (int i = 0; i < threadCount; ++i) {
+        const auto first = static_cast<std::uint32_t>((static_cast<std::int64_t>(totalBlocks) * i) / threadCount);
+        const auto last = static_cast<std::uint32_t>((static_cast<std::int64_t>(totalBlocks) * (i + 1)) / threadCount);
+        ranges[i].bounds.store(WorkRange::pack(first, last));
+    }
+
+    std::atomic<int> itemsDone(0);
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    const auto takeOwn = [&](WorkRange &own, std::uint32_t &first, std::uint32_t &last) {
+        std::uint64_t current = own.bounds.load();
+        while (true) {
+            const std::uint32_t b = WorkRange::begin(current);
+            const std::uint32_t e = WorkRange::end(current);
+            if (b >= e) {
+                return false;
+            }
+            const std::uint32_t chunk = std::max<std::uint32_t>(1, (e - b) / 4);
+            if (own.bounds.compare_exchange_weak(current, WorkRange::pack(b + chunk, e))) {
+                first = b;
+                last = b + chunk;
+                return true;
+            }
+        }
+    };
+
+    const auto stealInto = [&](int self) {
+        for (int offset = 1; offset < threadCount; ++offset) {
+            WorkRange &victim = ranges[(self + offset) % threadCount];
+            std::uint64_t current = victim.bounds.load();
+            while (true) {
+                const std::uint32_t b = WorkRange::begin(current);
+                const std::uint32_t e = WorkRange::end(current);
+                if (b >= e) {
+                    break;
+                }
+                const std::uint32_t mid = e - (e - b + 1) / 2;
+                if (victim.bounds.compare_exchange_weak(current, WorkRange::pack(b, mid))) {
+                    ranges[self].bounds.store(WorkRange::pack(mid, e));
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    auto workerFn = [&](int self) {
+        double busy = 0.0;
+        std::uint64_t chunks = 0;
+        std::uint64_t steals = 0;
+        while (!(cancel && cancel->load())) {
+            std::uint32_t first = 0;
+            std::uint32_t last = 0;
+            if (!takeOwn(ranges[self], first, last)) {
+                if (!stealInto(self)) {
+                    break;
+                }
+                ++steals;
+                continue;
+            }
+
+            const Clock::time_point chunkStart = Clock::now();
+            const int start = static_cast<int>(first) * blockSize;
+            const int end = std::min(static_cast<int>(last) * blockSize, totalItems);
+            for (int blockStart = start; blockStart < end; blockStart += blockSize) {
+                if (cancel && cancel->load()) {
+                    break;
+                }
+                blockFn(blockStart, std::min(blockStart + blockSize, end));
+            }
+            busy += std::chrono::duration<double>(Clock::now() - chunkStart).count();
+            ++chunks;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                itemsDone.fetch_add(end - start);
+            }
+            cv.notify_all();
+        }
+        detail::recordWorkerStats(self, busy, chunks, steals);
+    };
+
+    ThreadPool &pool = ThreadPool::shared();
+    pool.start(workerFn, threadCount);
+
+    int reportedItems = 0;
+    while (true) {
+        if (cancel && cancel->load()) {
+            break;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait_for(lock, std::chrono::milliseconds(30), [&]() {
+                return itemsDone.load() != reportedItems || (cancel && cancel->load());
+            });
+        }
+        const int completedItems = itemsDone.load();
+        if (completedItems > reportedItems) {
+            progressFn(completedItems - reportedItems);
+            reportedItems = completedItems;
+        }
+        if (completedItems >= totalItems) {
+            break;
+        }
+    }
+
+    pool.wait();
+    detail::recordWallTime(std::chrono::duration<double>(Clock::now() - wallStart).count());
+
+    return !(cancel && cancel->load());
+}
+
+} // namespace sdf
+
+#endif // SDF_PARALLEL_H
@@ -0,0 +1,166 @@
+#include "Quantize.h"
+
+#include <cmath>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SDF_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace sdf {
+
+namespace {
+
+#ifdef SDF_HAVE_SSE2
+// quantizeScaled() for two pairs of doubles; returns four output bytes in
+// the low 32 bits.
+inline int quantizeScaled4(__m128d low, __m128d high)
+{
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128i wholeLow = _mm_cvttpd_epi32(low);
+    const __m128i wholeHigh = _mm_cvttpd_epi32(high);
+    // All ones (-1) where the fraction rounds up.
+    const __m128i upLow = _mm_shuffle_epi32(
+        _mm_castpd_si128(_mm_cmpge_pd(_mm_sub_pd(low, _mm_cvtepi32_pd(wholeLow)), half)), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i upHigh = _mm_shuffle_epi32(
+        _mm_castpd_si128(_mm_cmpge_pd(_mm_sub_pd(high, _mm_cvtepi32_pd(wholeHigh)), half)), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i codes = _mm_unpacklo_epi64(_mm_sub_epi32(wholeLow, upLow), _mm_sub_epi32(wholeHigh, upHigh));
+    const __m128i codes16 = _mm_min_epi16(_mm_packs_epi32(codes, codes), _mm_set1_epi16(255));
+    const __m128i bytes = _mm_sub_epi16(_mm_set1_epi16(255), codes16);
+    return _mm_cvtsi128_si32(_mm_packus_epi16(bytes, bytes));
+}
+
+inline void storeBytes4(std::uint8_t *line, int value)
+{
+    const auto bits = static_cast<std::uint32_t>(value);
+    line[0] = static_cast<std::uint8_t>(bits);
+    line[1] = static_cast<std::uint8_t>(bits >> 8);
+    line[2] = static_cast<std::uint8_t>(bits >> 16);
+    line[3] = static_cast<std::uint8_t>(bits >> 24);
+}
+
+// SIMD prefixes of the float rows; each returns the number of pixels done.
+// They keep the scalar evaluation order (float subtraction or clamp, then
+// double arithmetic), so their bytes match the scalar loops.
+int quantizeMinMaxPrefix(const float *row, int count, float minDistance, double denom, std::uint8_t *line)
+{
+    const __m128 minimum = _mm_set1_ps(minDistance);
+    const __m128d divisor = _mm_set1_pd(denom);
+    const __m128d scale = _mm_set1_pd(255.0);
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        const __m128 offset = _mm_sub_ps(_mm_loadu_ps(row + x), minimum);
+        const __m128d low = _mm_mul_pd(_mm_div_pd(_mm_cvtps_pd(offset), divisor), scale);
+        const __m128d high = _mm_mul_pd(_mm_div_pd(_mm_cvtps_pd(_mm_movehl_ps(offset, offset)), divisor), scale);
+        storeBytes4(line + x, quantizeScaled4(low, high));
+    }
+    return x;
+}
+
+int quantizeFixedPrefix(const float *row, int count, float maxDistance, std::uint8_t *line)
+{
+    const __m128 upper = _mm_set1_ps(maxDistance);
+    const __m128 lower = _mm_set1_ps(-maxDistance);
+    const __m128d divisor = _mm_set1_pd(2.0 * maxDistance);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d scale = _mm_set1_pd(255.0);
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        const __m128 dist = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(row + x), lower), upper);
+        const __m128d low = _mm_mul_pd(_mm_add_pd(half, _mm_div_pd(_mm_cvtps_pd(dist), divisor)), scale);
+        const __m128d high = _mm_mul_pd(
+            _mm_add_pd(half, _mm_div_pd(_mm_cvtps_pd(_mm_movehl_ps(dist, dist)), divisor)), scale);
+        storeBytes4(line + x, quantizeScaled4(low, high));
+    }
+    return x;
+}
+
+int signedSqrtPrefix(const float *outsideSq, const float *insideSq, const BitMask::Word *bits, int count, float *row)
+{
+    const __m128i laneBits = _mm_set_epi32(8, 4, 2, 1);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    int x = 0;
+    for (; x + 4 <= count; x += 4) {
+        const auto nibble = static_cast<int>((bits[x / BitMask::kWordBits] >> (x % BitMask::kWordBits)) & 0xF);
+        const __m128 inside = _mm_castsi128_ps(
+            _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(nibble), laneBits), laneBits));
+        const __m128 squared = _mm_or_ps(_mm_and_ps(inside, _mm_loadu_ps(outsideSq + x)),
+                                         _mm_andnot_ps(inside, _mm_loadu_ps(insideSq + x)));
+        const __m128 dist = _mm_sqrt_ps(squared);
+        _mm_storeu_ps(row + x, _mm_xor_ps(dist, _mm_andnot_ps(inside, signBit)));
+    }
+    return x;
+}
+#endif
+
+} // namespace
+
+template <typename Real>
+void quantizeMinMaxRow(const Real *row, int count, Real minDistance, double denom, std::uint8_t *line)
+{
+    int x = 0;
+#ifdef SDF_HAVE_SSE2
+    if constexpr (std::is_same<Real, float>::value) {
+        x = quantizeMinMaxPrefix(row, count, minDistance, denom, line);
+    }
+#endif
+    for (; x < count; ++x) {
+        line[x] = quantizeScaled(((row[x] - minDistance) / denom) * 255.0);
+    }
+}
+
+template <typename Real>
+void quantizeFixedRow(const Real *row, int count, Real maxDistance, std::uint8_t *line)
+{
+    const double spread = 2.0 * maxDistance;
+    int x = 0;
+#ifdef SDF_HAVE_SSE2
+    if constexpr (std::is_same<Real, float>::value) {
+        x = quantizeFixedPrefix(row, count, maxDistance, line);
+    }
+#endif
+    for (; x < count; ++x) {
+        const Real dist = std::clamp(row[x], -maxDistance, maxDistance);
+        line[x] = quantizeScaled((0.5 + dist / spread) * 255.0);
+    }
+}
+
+template <typename Real>
+void signedSqrtRow(const Real *outsideSq, const Real *insideSq, const BitMask::Word *bits, int count, Real *row)
+{
+    int x = 0;
+#ifdef SDF_HAVE_SSE2
+    if constexpr (std::is_same<Real, float>::value) {
+        x = signedSqrtPrefix(outsideSq, insideSq, bits, count, row);
+    }
+#endif
+    for (; x < count; ++x) {
+        row[x] = BitMask::bitAt(bits, x) ? std::sqrt(outsideSq[x]) : -std::sqrt(insideSq[x]);
+    }
+}
+
+void quantizeFixedSquaredRow(
+    const SquaredDistance *sq,
+    const BitMask::Word *bits,
+    int x0,
+    int count,
+    float maxDistance,
+    float *distances,
+    std::uint8_t *line)
+{
+    for (int x = 0; x < count; ++x) {
+        const float dist = std::sqrt(static_cast<float>(sq[x]));
+        distances[x] = BitMask::bitAt(bits, x0 + x) ? dist : -dist;
+    }
+    quantizeFixedRow(distances, count, maxDistance, line);
+}
+
+template void quantizeMinMaxRow<float>(const float *, int, float, double, std::uint8_t *);
+template void quantizeMinMaxRow<double>(const double *, int, double, double, std::uint8_t *);
+template void quantizeFixedRow<float>(const float *, int, float, std::uint8_t *);
+template void quantizeFixedRow<double>(const double *, int, double, std::uint8_t *);
+template void signedSqrtRow<float>(const float *, const float *, const BitMask::Word *, int, float *);
+template void signedSqrtRow<double>(const double *, const double *, const BitMask::Word *, int, double *);
+
+} // namespace sdf
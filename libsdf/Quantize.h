@@ -0,0 +1,61 @@
+#ifndef SDF_QUANTIZE_H
+#define SDF_QUANTIZE_H
+
+#include "BitMask.h"
+#include "DistanceTransform.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace sdf {
+
+// Output byte for a normalized distance in [0, 1] (values past 1 saturate):
+// 255 - round(normalized * 255), inside pixels dark. lround() is split into
+// truncation plus a half test, which agrees with it for non-negative values
+// and vectorizes.
+inline std::uint8_t quantizeScaled(double scaled)
+{
+    const int whole = static_cast<int>(scaled);
+    const int code = std::min(255, whole + (scaled - whole >= 0.5 ? 1 : 0));
+    return static_cast<std::uint8_t>(255 - code);
+}
+
+// Min/max normalization of one row: quantizeScaled((row - minDistance) /
+// denom * 255) with denom > 0.
+template <typename Real>
+void quantizeMinMaxRow(const Real *row, int count, Real minDistance, double denom, std::uint8_t *line);
+
+// Fixed-spread normalization of one row: row is clamped to +-maxDistance and
+// mapped as 0.5 + d / (2 * maxDistance).
+template <typename Real>
+void quantizeFixedRow(const Real *row, int count, Real maxDistance, std::uint8_t *line);
+
+// row[x] = sqrt(outsideSq[x]) for inside pixels and -sqrt(insideSq[x]) for
+// outside pixels of a mask row. The float versions of these kernels run four
+// pixels per step with SSE2 where available.
+template <typename Real>
+void signedSqrtRow(const Real *outsideSq, const Real *insideSq, const BitMask::Word *bits, int count, Real *row);
+
+// Fixed-spread bytes for count pixels of a mask row starting at column x0,
+// from their squared distances to the other class: quantizeFixedRow() of
+// sqrt(sq) for inside pixels and -sqrt(sq) for outside ones, in float.
+// distances is scratch for count values.
+void quantizeFixedSquaredRow(
+    const SquaredDistance *sq,
+    const BitMask::Word *bits,
+    int x0,
+    int count,
+    float maxDistance,
+    float *distances,
+    std::uint8_t *line);
+
+extern template void quantizeMinMaxRow<float>(const float *, int, float, double, std::uint8_t *);
+extern template void quantizeMinMaxRow<double>(const double *, int, double, double, std::uint8_t *);
+extern template void quantizeFixedRow<float>(const float *, int, float, std::uint8_t *);
+extern template void quantizeFixedRow<double>(const double *, int, double, std::uint8_t *);
+extern template void signedSqrtRow<float>(const float *, const float *, const BitMask::Word *, int, float *);
+extern template void signedSqrtRow<double>(const double *, const double *, const BitMask::Word *, int, double *);
+
+} // namespace sdf
+
+#endif // SDF_QUANTIZE_H
@@ -0,0 +1,142 @@
+#include "RunMask.h"
+
+#include <algorithm>
+
+namespace sdf {
+
+namespace {
+
+// Sets bits [x0, x1) of a packed row.
+void setBits(BitMask::Word *bits, int x0, int x1)
+{
+    constexpr int kBits = BitMask::kWordBits;
+    constexpr BitMask::Word kAll = ~BitMask::Word(0);
+    if (x0 >= x1) {
+        return;
+    }
+    const int first = x0 / kBits;
+    const int last = (x1 - 1) / kBits;
+    const BitMask::Word head = kAll << (x0 % kBits);
+    const BitMask::Word tail = kAll >> (kBits - 1 - (x1 - 1) % kBits);
+    if (first == last) {
+        bits[first] |= head & tail;
+        return;
+    }
+    bits[first] |= head;
+    std::fill(bits + first + 1, bits + last, kAll);
+    bits[last] |= tail;
+}
+
+} // namespace
+
+RunMask::RunMask(int width)
+    : maskWidth(std::max(width, 0))
+{
+}
+
+bool RunMask::get(int x, int y) const
+{
+    const Span<const int> toggles = rowEdges(y);
+    const auto passed = std::upper_bound(toggles.data(), toggles.data() + toggles.size(), x) - toggles.data();
+    return (passed & 1) != 0;
+}
+
+void RunMask::appendRow(const std::uint8_t *pixels, int pixelStride, int threshold)
+{
+    rowBits.resize((static_cast<std::size_t>(maskWidth) + BitMask::kWordBits - 1) / BitMask::kWordBits);
+    packThreshold(pixels, maskWidth, pixelStride, threshold, rowBits.data());
+    appendRow(rowBits.data());
+}
+
+void RunMask::appendRow(const BitMask::Word *bits)
+{
+    bool value = false;
+    int x = 0;
+    while (true) {
+        x = BitMask::findChange(bits, maskWidth, x, value);
+        if (x >= maskWidth) {
+            break;
+        }
+        edges.push_back(x);
+        value = !value;
+    }
+    rowStart.push_back(edges.size());
+}
+
+void RunMask::appendEdges(Span<const int> rowToggles)
+{
+    edges.insert(edges.end(), rowToggles.data(), rowToggles.data() + rowToggles.size());
+    rowStart.push_back(edges.size());
+}
+
+void RunMask::packRow(int y, BitMask::Word *bits) const
+{
+    const std::size_t words = (static_cast<std::size_t>(maskWidth) + BitMask::kWordBits - 1) / BitMask::kWordBits;
+    std::fill(bits, bits + words, BitMask::Word(0));
+    const Span<const int> toggles = rowEdges(y);
+    for (std::size_t i = 0; i < toggles.size(); i += 2) {
+        setBits(bits, toggles[i], i + 1 < toggles.size() ? toggles[i + 1] : maskWidth);
+    }
+}
+
+void RunMask::unpackRow(int x0, int y, Span<std::uint8_t> line) const
+{
+    const Span<const int> toggles = rowEdges(y);
+    const int *edge = std::upper_bound(toggles.data(), toggles.data() + toggles.size(), x0);
+    const int *edgeEnd = toggles.data() + toggles.size();
+    bool inside = ((edge - toggles.data()) & 1) != 0;
+    const int x1 = x0 + static_cast<int>(line.size());
+    for (int x = x0; x < x1;) {
+        const int runEnd = edge < edgeEnd ? std::min(*edge, x1) : x1;
+        std::fill(line.data() + (x - x0), line.data() + (runEnd - x0), inside ? 1 : 0);
+        x = runEnd;
+        if (edge < edgeEnd && *edge == x) {
+            inside = !inside;
+            ++edge;
+        }
+    }
+}
+
+RunMask runMaskFromImage(const GrayImageView &image, int bytesPerPixel, int channel, int threshold)
+{
+    if (image.isNull() || bytesPerPixel <= 0 || channel < 0 || channel >= bytesPerPixel) {
+        return RunMask();
+    }
+    RunMask mask(image.width);
+    for (int y = 0; y < image.height; ++y) {
+        mask.appendRow(image.row(y) + channel, bytesPerPixel, threshold);
+    }
+    return mask;
+}
+
+RunMask resampleRunMask(const RunMask &mask, int width, int height)
+{
+    if (mask.isNull() || width <= 0 || height <= 0) {
+        return RunMask();
+    }
+    const std::int64_t inW = mask.width();
+    const std::int64_t inH = mask.height();
+    RunMask resampled(width);
+    std::vector<int> toggles;
+    for (int y = 0; y < height; ++y) {
+        // Output column x samples x * inW / width, so a source toggle at e
+        // moves to the first x with x * inW >= e * width; toggles that land
+        // on the same column cancel.
+        toggles.clear();
+        for (const int edge : mask.rowEdges(static_cast<int>((y * inH) / height))) {
+            const int x = static_cast<int>((edge * static_cast<std::int64_t>(width) + inW - 1) / inW);
+            if (x >= width) {
+                break;
+            }
+            if (!toggles.empty() && toggles.back() == x) {
+                toggles.pop_back();
+            } else {
+                toggles.push_back(x);
+            }
+        }
+        resampled.appendEdges(toggles);
+    }
+    return resampled;
+}
+
+} // namespace sdf
@@ -0,0 +1,71 @@
+#ifndef SDF_RUNMASK_H
+#define SDF_RUNMASK_H
+
+#include "BitMask.h"
+#include "ImageView.h"
+#include "Span.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sdf {
+
+// Binary image stored as runs: every row keeps the sorted columns where the
+// value toggles, starting outside to the left of column 0 (a row that
+// starts inside toggles at 0), so a row costs one int per run boundary
+// whatever its width. Rows are appended one scanline at a time,
+// straight from a decoder, and never need the whole image in memory.
+class RunMask
+{
+public:
+    RunMask() = default;
+    // No rows yet.
+    explicit RunMask(int width);
+
+    int width() const { return maskWidth; }
+    int height() const { return static_cast<int>(rowStart.size()) - 1; }
+    bool isNull() const { return maskWidth <= 0 || height() <= 0; }
+
+    // Toggle columns of row y, ascending, each in [0, width).
+    Span<const int> rowEdges(int y) const
+    {
+        return Span<const int>(edges.data() + rowStart[y], rowStart[y + 1] - rowStart[y]);
+    }
+    std::size_t edgeCount() const { return edges.size(); }
+
+    bool get(int x, int y) const;
+
+    // Appends a row thresholded like packThreshold(): pixels spaced
+    // pixelStride bytes apart are inside where the byte is > threshold.
+    void appendRow(const std::uint8_t *pixels, int pixelStride, int threshold);
+    // Appends a packed row of width bits.
+    void appendRow(const BitMask::Word *bits);
+    // Appends a row from its toggle columns, which must be ascending and in
+    // [0, width).
+    void appendEdges(Span<const int> rowToggles);
+
+    // Writes row y as wordsPerRow packed words, padding bits clear.
+    void packRow(int y, BitMask::Word *bits) const;
+
+    // Writes 0 / 1 bytes for columns [x0, x0 + line.size()) of row y.
+    void unpackRow(int x0, int y, Span<std::uint8_t> line) const;
+
+private:
+    int maskWidth = 0;
+    std::vector<int> edges;
+    std::vector<std::size_t> rowStart{0};
+    std::vector<BitMask::Word> rowBits;
+};
+
+// Thresholds every row of image into runs, like thresholdImage().
+RunMask runMaskFromImage(const GrayImageView &image, int bytesPerPixel, int channel, int threshold);
+
+// Nearest-neighbour resample to width x height with the sampling of
+// generateSdf(): output (x, y) takes source (x * w / width, y * h / height).
+// Works on the toggle columns only, without expanding any row.
+RunMask resampleRunMask(const RunMask &mask, int width, int height);
+
+} // namespace sdf
+
+#endif // SDF_RUNMASK_H
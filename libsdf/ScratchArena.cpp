@@ -0,0 +1,56 @@
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+
+namespace sdf {
+
+namespace {
+std::atomic<std::uint64_t> allocationCounter(0);
+}
+
+ScratchArena::~ScratchArena()
+{
+    for (Block &block : blocks) {
+        if (block.data) {
+            ::operator delete(block.data, std::align_val_t(kAlignment));
+        }
+    }
+}
+
+ScratchArena &ScratchArena::local()
+{
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+std::size_t ScratchArena::bytesReserved() const
+{
+    std::size_t total = 0;
+    for (const Block &block : blocks) {
+        total += block.capacity;
+    }
+    return total;
+}
+
+void ScratchArena::grow(Block &block, std::size_t bytes)
+{
+    std::size_t capacity = std::max(bytes, block.capacity * 2);
+    capacity = (capacity + kAlignment - 1) / kAlignment * kAlignment;
+    if (block.data) {
+        ::operator delete(block.data, std::align_val_t(kAlignment));
+        block.data = nullptr;
+        block.capacity = 0;
+    }
+    block.data = ::operator new(capacity, std::align_val_t(kAlignment));
+    block.capacity = capacity;
+    allocationCounter.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t scratchAllocationCount()
+{
+    return allocationCounter.load(std::memory_order_relaxed);
+}
+
+} // namespace sdf
@@ -0,0 +1,74 @@
+#ifndef SDF_SCRATCHARENA_H
+#define SDF_SCRATCHARENA_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sdf {
+
+// Per-thread pool of cache-line aligned scratch buffers. Each slot keeps its
+// largest allocation alive for the lifetime of the thread, so once the
+// buffers have grown to the working size the transforms do not touch the
+// heap at all.
+class ScratchArena
+{
+public:
+    enum Slot
+    {
+        EnvelopeSites,
+        EnvelopeBounds,
+        LineInput,
+        LineOutput,
+        TileColumn,
+        TileDistances,
+        TileCodes,
+        ContourLeaves,
+        SlotCount
+    };
+
+    static constexpr std::size_t kAlignment = 64;
+
+    ScratchArena() = default;
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    // Arena owned by the calling thread.
+    static ScratchArena &local();
+
+    // Returns storage for at least count values of T in the given slot. The
+    // contents are unspecified and are invalidated by the next call for the
+    // same slot with a larger size.
+    template <typename T>
+    T *get(Slot slot, std::size_t count)
+    {
+        const std::size_t bytes = count * sizeof(T);
+        Block &block = blocks[slot];
+        if (bytes > block.capacity) {
+            grow(block, bytes);
+        }
+        return static_cast<T *>(block.data);
+    }
+
+    std::size_t bytesReserved() const;
+
+private:
+    struct Block
+    {
+        void *data = nullptr;
+        std::size_t capacity = 0;
+    };
+
+    static void grow(Block &block, std::size_t bytes);
+
+    Block blocks[SlotCount];
+};
+
+// Number of heap allocations performed by all scratch arenas so far. Stays
+// constant across repeated jobs of the same size.
+std::uint64_t scratchAllocationCount();
+
+} // namespace sdf
+
+#endif // SDF_SCRATCHARENA_H
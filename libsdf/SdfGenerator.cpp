@@ -0,0 +1,1160 @@
+#include "SdfGenerator.h"
+
+#include "AntiAliased.h"
+#include "BitMask.h"
+#include "Contour.h"
+#include "DistanceTransform.h"
+#include "MappedBuffer.h"
+#include "Meijster.h"
+#include "NarrowBand.h"
+#include "Quantize.h"
+#include "RunMask.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace sdf {
+
+int progressUnits(const SdfOptions &options)
+{
+    return (5 * options.outHeight) + (2 * options.outWidth);
+}
+
+namespace {
+
+// Nearest-neighbour resample of the source to the output size, thresholded
+// (pixels > threshold are inside) and packed, rows in parallel, for the
+// output pixels in window; mask pixel (0, 0) is window corner (x0, y0).
+// Rows at the source width are packed straight from the source; other rows
+// gather their columns through a precomputed index table first. Reports
+// one unit per window row.
+Status buildInsideMask(
+    const GrayImageView &source,
+    const SdfOptions &options,
+    const SdfRect &window,
+    BitMask &insideMask,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    const int outWidth = options.outWidth;
+    const int outHeight = options.outHeight;
+    const int inW = source.width;
+    const int inH = source.height;
+    const int maskWidth = window.width();
+
+    std::vector<int> sourceColumns(static_cast<size_t>(maskWidth));
+    for (int x = 0; x < maskWidth; ++x) {
+        const std::int64_t ox = window.x0 + x;
+        sourceColumns[x] = static_cast<int>((ox * inW) / outWidth);
+    }
+
+    insideMask = BitMask(maskWidth, window.height());
+    const auto rowBlock = [&](int start, int end) {
+        std::uint8_t *line = ScratchArena::local().get<std::uint8_t>(ScratchArena::LineInput, maskWidth);
+        for (int y = start; y < end; ++y) {
+            const std::int64_t oy = window.y0 + y;
+            const std::uint8_t *row = source.row(static_cast<int>((oy * inH) / outHeight));
+            if (outWidth != inW) {
+                for (int x = 0; x < maskWidth; ++x) {
+                    line[x] = row[sourceColumns[x]];
+                }
+                row = line;
+            } else {
+                row += window.x0;
+            }
+            packThreshold(row, maskWidth, 1, options.threshold, insideMask.row(y));
+        }
+    };
+    if (!runParallelBlocks(window.height(), chooseBlockSize(window.height()), cancel, rowBlock, report)) {
+        return Status::Canceled;
+    }
+    return Status::Ok;
+}
+
+// rect grown by margin on every side and clipped to width x height.
+SdfRect growRect(const SdfRect &rect, int margin, int width, int height)
+{
+    if (rect.isEmpty()) {
+        return SdfRect();
+    }
+    SdfRect grown;
+    grown.x0 = std::max(0, rect.x0 - margin);
+    grown.y0 = std::max(0, rect.y0 - margin);
+    grown.x1 = std::min(width, rect.x1 + margin);
+    grown.y1 = std::min(height, rect.y1 + margin);
+    if (grown.isEmpty()) {
+        return SdfRect();
+    }
+    return grown;
+}
+
+// Shared validation of the generators.
+Status checkOutput(const SdfOptions &options, const OutputImageView &output)
+{
+    if (options.outWidth <= 0 || options.outHeight <= 0 || output.isNull()
+        || output.width < options.outWidth || output.height < options.outHeight) {
+        return Status::InvalidOutputSize;
+    }
+    return Status::Ok;
+}
+
+// True when the integer engines keep every distance that matters for the
+// output: squared distances saturate at kInfinityValue<SquaredDistance>,
+// which is harmless below the clamp or when the output diagonal fits.
+bool integerDistancesFit(const SdfOptions &options)
+{
+    constexpr std::int64_t limit = kInfinityValue<SquaredDistance>;
+    const std::int64_t maxDistance = options.maxDistance;
+    if (maxDistance > 0 && maxDistance * maxDistance < limit) {
+        return true;
+    }
+    const std::int64_t width = options.outWidth;
+    const std::int64_t height = options.outHeight;
+    return width * width + height * height < limit;
+}
+
+// Output for an image without any distance spread (normalized 0.5).
+constexpr std::uint8_t kFlatCode = 255 - 128;
+
+// Clamps the signed distances that distanceRow(y, row) writes for each row
+// and normalizes them to the output range. Both passes run on the pool; the
+// min/max is reduced per block and merged once per block. Fixed-range
+// normalization needs no reduction and runs as a single pass.
+template <typename Real, typename DistanceRowFn>
+Status finalizeSdf(
+    const SdfOptions &options,
+    const DistanceRowFn &distanceRow,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    const int outWidth = options.outWidth;
+    const int outHeight = options.outHeight;
+    const Real maxDistance = static_cast<Real>(options.maxDistance);
+
+    if (options.normalization == Normalization::FixedRange && options.maxDistance > 0) {
+        // One pass: each row is computed into scratch and quantized straight
+        // into output, so no full-size distance buffer is kept.
+        const auto streamBlock = [&](int start, int end) {
+            Real *row = ScratchArena::local().get<Real>(ScratchArena::LineOutput, outWidth);
+            for (int y = start; y < end; ++y) {
+                distanceRow(y, row);
+                quantizeFixedRow(row, outWidth, maxDistance, output.row(y));
+            }
+        };
+        const auto reportRows = [&report](int rows) {
+            report(2 * rows);
+        };
+        if (!runParallelBlocks(outHeight, chooseBlockSize(outHeight), cancel, streamBlock, reportRows)) {
+            return Status::Canceled;
+        }
+        return Status::Ok;
+    }
+
+    std::vector<Real> signedDistances(static_cast<size_t>(outWidth) * outHeight);
+    Real minDistance = std::numeric_limits<Real>::max();
+    Real maxDistanceValue = std::numeric_limits<Real>::lowest();
+    std::mutex rangeMutex;
+
+    const auto clampBlock = [&](int start, int end) {
+        Real blockMin = std::numeric_limits<Real>::max();
+        Real blockMax = std::numeric_limits<Real>::lowest();
+        for (int y = start; y < end; ++y) {
+            Real *row = signedDistances.data() + static_cast<size_t>(y) * outWidth;
+            distanceRow(y, row);
+            if (maxDistance > 0) {
+                for (int x = 0; x < outWidth; ++x) {
+                    row[x] = std::clamp(row[x], -maxDistance, maxDistance);
+                }
+            }
+            for (int x = 0; x < outWidth; ++x) {
+                blockMin = std::min(blockMin, row[x]);
+                blockMax = std::max(blockMax, row[x]);
+            }
+        }
+        std::lock_guard<std::mutex> lock(rangeMutex);
+        minDistance = std::min(minDistance, blockMin);
+        maxDistanceValue = std::max(maxDistanceValue, blockMax);
+    };
+    if (!runParallelBlocks(outHeight, chooseBlockSize(outHeight), cancel, clampBlock, report)) {
+        return Status::Canceled;
+    }
+
+    const double denom = static_cast<double>(maxDistanceValue) - minDistance;
+    const auto normalizeBlock = [&](int start, int end) {
+        for (int y = start; y < end; ++y) {
+            std::uint8_t *line = output.row(y);
+            const Real *row = signedDistances.data() + static_cast<size_t>(y) * outWidth;
+            if (denom > 0.0) {
+                quantizeMinMaxRow(row, outWidth, minDistance, denom, line);
+            } else {
+                std::fill(line, line + outWidth, kFlatCode);
+            }
+        }
+    };
+    if (!runParallelBlocks(outHeight, chooseBlockSize(outHeight), cancel, normalizeBlock, report)) {
+        return Status::Canceled;
+    }
+
+    return Status::Ok;
+}
+
+// Signed distances of one row from squared distances to the other class.
+void signedDistanceRow(const BitMask::Word *bits, const SquaredDistance *sq, int width, float *row)
+{
+    for (int x = 0; x < width; ++x) {
+        const float dist = std::sqrt(static_cast<float>(sq[x]));
+        row[x] = BitMask::bitAt(bits, x) ? dist : -dist;
+    }
+}
+
+// finalizeSdf() for the integer engines. oppositeRow(y, scratch) returns the
+// squared distances of row y to the other class, in place or in scratch.
+// The output byte of a pixel depends only on its class and squared
+// distance, so once the range is known (fixed spread, or an integer min/max
+// reduction) a table indexed by the clamped squared distance replaces the
+// sqrt, clamp and quantize work. The table is only built when it is small
+// next to the image; otherwise each row is quantized directly.
+template <typename OppositeRowFn>
+Status finalizeSquared(
+    const SdfOptions &options,
+    const BitMask &insideMask,
+    const OppositeRowFn &oppositeRow,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    const int outWidth = options.outWidth;
+    const int outHeight = options.outHeight;
+    const size_t pixelCount = static_cast<size_t>(outWidth) * outHeight;
+    const float maxDistance = static_cast<float>(options.maxDistance);
+    const SquaredDistance capSq = options.maxDistance > 0
+        ? static_cast<SquaredDistance>(options.maxDistance) * static_cast<SquaredDistance>(options.maxDistance)
+        : kInfinityValue<SquaredDistance>;
+    const auto tableFits = [pixelCount](SquaredDistance tableMax) {
+        return tableMax < (1u << 24) && 2 * (static_cast<size_t>(tableMax) + 1) <= pixelCount;
+    };
+    // Same float arithmetic as signedDistanceRow() followed by the clamp.
+    const auto signedDistance = [&](bool inside, SquaredDistance sq) {
+        const float dist = std::sqrt(static_cast<float>(sq));
+        const float value = inside ? dist : -dist;
+        return options.maxDistance > 0 ? std::clamp(value, -maxDistance, maxDistance) : value;
+    };
+    const auto scratchRow = [outWidth]() {
+        return ScratchArena::local().get<SquaredDistance>(ScratchArena::LineInput, outWidth);
+    };
+
+    const bool fixedRange = options.normalization == Normalization::FixedRange && options.maxDistance > 0;
+    if (fixedRange && !tableFits(capSq)) {
+        const auto distanceRow = [&](int y, float *row) {
+            signedDistanceRow(insideMask.row(y), oppositeRow(y, scratchRow()), outWidth, row);
+        };
+        return finalizeSdf<float>(options, distanceRow, output, cancel, report);
+    }
+
+    float minDistance = 0.0f;
+    double denom = 0.0;
+    SquaredDistance tableMax = capSq;
+    if (!fixedRange) {
+        // Extremes per class; the signed distance is monotonic in the
+        // squared distance, so they give the exact float min/max.
+        struct Extremes
+        {
+            SquaredDistance minSq[2] = {kInfinityValue<SquaredDistance>, kInfinityValue<SquaredDistance>};
+            SquaredDistance maxSq[2] = {0, 0};
+            bool present[2] = {false, false};
+        };
+        Extremes extremes;
+        std::mutex extremesMutex;
+        const auto rangeBlock = [&](int start, int end) {
+            Extremes local;
+            for (int y = start; y < end; ++y) {
+                const SquaredDistance *sq = oppositeRow(y, scratchRow());
+                const BitMask::Word *bits = insideMask.row(y);
+                for (int x = 0; x < outWidth; ++x) {
+                    const int side = BitMask::bitAt(bits, x) ? 1 : 0;
+                    local.minSq[side] = std::min(local.minSq[side], sq[x]);
+                    local.maxSq[side] = std::max(local.maxSq[side], sq[x]);
+                    local.present[side] = true;
+                }
+            }
+            std::lock_guard<std::mutex> lock(extremesMutex);
+            for (int side = 0; side < 2; ++side) {
+                extremes.minSq[side] = std::min(extremes.minSq[side], local.minSq[side]);
+                extremes.maxSq[side] = std::max(extremes.maxSq[side], local.maxSq[side]);
+                extremes.present[side] = extremes.present[side] || local.present[side];
+            }
+        };
+        if (!runParallelBlocks(outHeight, chooseBlockSize(outHeight), cancel, rangeBlock, report)) {
+            return Status::Canceled;
+        }
+
+        float lowest = std::numeric_limits<float>::max();
+        float highest = std::numeric_limits<float>::lowest();
+        for (int side = 0; side < 2; ++side) {
+            if (extremes.present[side]) {
+                for (const SquaredDistance sq : {extremes.minSq[side], extremes.maxSq[side]}) {
+                    lowest = std::min(lowest, signedDistance(side == 1, sq));
+                    highest = std::max(highest, signedDistance(side == 1, sq));
+                }
+            }
+        }
+        minDistance = lowest;
+        denom = static_cast<double>(highest) - lowest;
+        tableMax = std::min(capSq, std::max(extremes.maxSq[0], extremes.maxSq[1]));
+    }
+
+    const bool useTable = (fixedRange || denom > 0.0) && tableFits(tableMax);
+    std::vector<std::uint8_t> table;
+    if (useTable) {
+        // Entries [0, tableMax] for outside pixels, then for inside pixels.
+        const size_t entries = static_cast<size_t>(tableMax) + 1;
+        table.resize(2 * entries);
+        std::vector<float> distances(entries);
+        for (int side = 0; side < 2; ++side) {
+            for (size_t sq = 0; sq < entries; ++sq) {
+                distances[sq] = signedDistance(side == 1, static_cast<SquaredDistance>(sq));
+            }
+            std::uint8_t *codes = table.data() + side * entries;
+            if (fixedRange) {
+                quantizeFixedRow(distances.data(), static_cast<int>(entries), maxDistance, codes);
+            } else {
+                quantizeMinMaxRow(distances.data(), static_cast<int>(entries), minDistance, denom, codes);
+            }
+        }
+    }
+
+    const auto quantizeBlock = [&](int start, int end) {
+        float *distances = ScratchArena::local().get<float>(ScratchArena::LineOutput, outWidth);
+        const size_t entries = static_cast<size_t>(tableMax) + 1;
+        for (int y = start; y < end; ++y) {
+            std::uint8_t *line = output.row(y);
+            const BitMask::Word *bits = insideMask.row(y);
+            if (!fixedRange && !(denom > 0.0)) {
+                std::fill(line, line + outWidth, kFlatCode);
+                continue;
+            }
+            const SquaredDistance *sq = oppositeRow(y, scratchRow());
+            if (useTable) {
+                for (int x = 0; x < outWidth; ++x) {
+                    const size_t index = std::min(sq[x], tableMax) + (BitMask::bitAt(bits, x) ? entries : 0);
+                    line[x] = table[index];
+                }
+                continue;
+            }
+            signedDistanceRow(bits, sq, outWidth, distances);
+            if (options.maxDistance > 0) {
+                for (int x = 0; x < outWidth; ++x) {
+                    distances[x] = std::clamp(distances[x], -maxDistance, maxDistance);
+                }
+            }
+            quantizeMinMaxRow(distances, outWidth, minDistance, denom, line);
+        }
+    };
+    const auto reportRows = [&report, fixedRange](int rows) {
+        report(fixedRange ? 2 * rows : rows);
+    };
+    if (!runParallelBlocks(outHeight, chooseBlockSize(outHeight), cancel, quantizeBlock, reportRows)) {
+        return Status::Canceled;
+    }
+    return Status::Ok;
+}
+
+template <typename T>
+Status generateFullRange(
+    const BitMask &insideMask,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    const auto isCanceled = [cancel]() {
+        return cancel && cancel->load();
+    };
+    const MappedBuffer distOutsideSq = mappedDistanceTransform2D<T>(insideMask, false, cancel, report);
+    if (distOutsideSq.size() == 0) {
+        return isCanceled() ? Status::Canceled : Status::TransformFailed;
+    }
+
+    const MappedBuffer distInsideSq = mappedDistanceTransform2D<T>(insideMask, true, cancel, report);
+    if (distInsideSq.size() == 0) {
+        return isCanceled() ? Status::Canceled : Status::TransformFailed;
+    }
+
+    const auto distanceRow = [&](int y, T *row) {
+        const size_t rowOffset = static_cast<size_t>(y) * options.outWidth;
+        signedSqrtRow(distOutsideSq.data<const T>() + rowOffset, distInsideSq.data<const T>() + rowOffset,
+                      insideMask.row(y), options.outWidth, row);
+    };
+    return finalizeSdf<T>(options, distanceRow, output, cancel, report);
+}
+
+// Both fields of the exact engine in one fused transform, fed from runs
+// when the mask came as a RunMask.
+Status generateExactSigned(
+    const BitMask &insideMask,
+    const RunMask *runs,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    const MappedBuffer oppositeSq = runs
+        ? mappedSignedDistanceTransform2D(*runs, cancel, report)
+        : mappedSignedDistanceTransform2D(insideMask, cancel, report);
+    if (oppositeSq.size() == 0) {
+        return (cancel && cancel->load()) ? Status::Canceled : Status::TransformFailed;
+    }
+
+    const auto oppositeRow = [&](int y, SquaredDistance *) {
+        return oppositeSq.data<const SquaredDistance>() + static_cast<size_t>(y) * options.outWidth;
+    };
+    return finalizeSquared(options, insideMask, oppositeRow, output, cancel, report);
+}
+
+Status generateMeijster(
+    const BitMask &insideMask,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    const auto isCanceled = [cancel]() {
+        return cancel && cancel->load();
+    };
+
+    const std::vector<SquaredDistance> distOutsideSq =
+        meijsterDistanceTransform(insideMask, false, cancel, report);
+    if (distOutsideSq.empty()) {
+        return isCanceled() ? Status::Canceled : Status::TransformFailed;
+    }
+
+    const std::vector<SquaredDistance> distInsideSq =
+        meijsterDistanceTransform(insideMask, true, cancel, report);
+    if (distInsideSq.empty()) {
+        return isCanceled() ? Status::Canceled : Status::TransformFailed;
+    }
+
+    const auto oppositeRow = [&](int y, SquaredDistance *scratch) {
+        const size_t rowOffset = static_cast<size_t>(y) * options.outWidth;
+        const BitMask::Word *bits = insideMask.row(y);
+        for (int x = 0; x < options.outWidth; ++x) {
+            scratch[x] = BitMask::bitAt(bits, x) ? distOutsideSq[rowOffset + x] : distInsideSq[rowOffset + x];
+        }
+        return static_cast<const SquaredDistance *>(scratch);
+    };
+    return finalizeSquared(options, insideMask, oppositeRow, output, cancel, report);
+}
+
+Status generateNarrowBand(
+    const BitMask &insideMask,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    const size_t pixelCount = static_cast<size_t>(options.outWidth) * options.outHeight;
+    const MappedBuffer oppositeSq(pixelCount * sizeof(SquaredDistance));
+    const Span<SquaredDistance> distances(oppositeSq.data<SquaredDistance>(), pixelCount);
+    const bool computed = options.coarseToFine
+        ? coarseToFineDistances(insideMask, options.maxDistance, distances, cancel, report)
+        : narrowBandDistances(insideMask, options.maxDistance, distances, cancel, report);
+    if (!computed) {
+        return (cancel && cancel->load()) ? Status::Canceled : Status::TransformFailed;
+    }
+
+    const auto oppositeRow = [&](int y, SquaredDistance *) {
+        return distances.data() + static_cast<size_t>(y) * options.outWidth;
+    };
+    return finalizeSquared(options, insideMask, oppositeRow, output, cancel, report);
+}
+
+template <typename T>
+Status generateAntiAliased(
+    const GrayImageView &source,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    const std::vector<T> coverage =
+        resampleCoverage<T>(source, options.outWidth, options.outHeight, options.threshold, cancel);
+    if (coverage.empty()) {
+        return (cancel && cancel->load()) ? Status::Canceled : Status::TransformFailed;
+    }
+    report(options.outHeight);
+
+    std::vector<T> signedDistances(coverage.size());
+    if (!antiAliasedSignedDistances<T>(coverage, options.outWidth, options.outHeight, signedDistances, cancel, report)) {
+        return (cancel && cancel->load()) ? Status::Canceled : Status::TransformFailed;
+    }
+
+    const auto distanceRow = [&](int y, T *row) {
+        const T *src = signedDistances.data() + static_cast<size_t>(y) * options.outWidth;
+        std::copy(src, src + options.outWidth, row);
+    };
+    return finalizeSdf<T>(options, distanceRow, output, cancel, report);
+}
+
+// Engine selection once the mask is at the output size. runs, if not null,
+// holds the same mask as runs.
+Status generateFromMask(
+    const BitMask &insideMask,
+    const RunMask *runs,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    // Past the SquaredDistance range the double transform takes over; float
+    // squares stop being exact past 4096 pixels.
+    const bool integerFits = integerDistancesFit(options);
+    if ((options.narrowBand || options.coarseToFine) && options.maxDistance > 0 && integerFits) {
+        return generateNarrowBand(insideMask, options, output, cancel, report);
+    }
+    if (options.engine == Engine::Meijster && integerFits) {
+        return generateMeijster(insideMask, options, output, cancel, report);
+    }
+
+    switch (resolvePrecision(options.precision, true, true)) {
+    case Precision::Double:
+        return generateFullRange<double>(insideMask, options, output, cancel, report);
+    case Precision::Exact:
+        if (integerFits) {
+            return generateExactSigned(insideMask, runs, options, output, cancel, report);
+        }
+        return generateFullRange<double>(insideMask, options, output, cancel, report);
+    default:
+        return generateFullRange<float>(insideMask, options, output, cancel, report);
+    }
+}
+
+// runs packed into insideMask, rows in parallel. Takes the place of
+// buildInsideMask() for run-length input and reports the same units.
+Status packRunMask(const RunMask &runs, BitMask &insideMask, std::atomic_bool *cancel, const ProgressFn &report)
+{
+    insideMask = BitMask(runs.width(), runs.height());
+    const auto packBlock = [&](int start, int end) {
+        for (int y = start; y < end; ++y) {
+            runs.packRow(y, insideMask.row(y));
+        }
+    };
+    if (!runParallelBlocks(runs.height(), chooseBlockSize(runs.height()), cancel, packBlock, report)) {
+        return Status::Canceled;
+    }
+    return Status::Ok;
+}
+
+// Signed distances of mask in its own pixels, positive inside: the narrow
+// band when band > 0, else the exact signed transform, or the double
+// transform past the SquaredDistance range. runs, if not null, holds the
+// same mask as runs. Reports 2 * (width + height) units.
+Status maskField(
+    const BitMask &mask,
+    const RunMask *runs,
+    int band,
+    std::vector<float> &field,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    const int width = mask.width();
+    const int height = mask.height();
+    const size_t pixelCount = static_cast<size_t>(width) * height;
+    const auto failed = [cancel]() {
+        return (cancel && cancel->load()) ? Status::Canceled : Status::TransformFailed;
+    };
+    field.resize(pixelCount);
+
+    SdfOptions grid;
+    grid.outWidth = width;
+    grid.outHeight = height;
+    grid.maxDistance = band;
+    if (integerDistancesFit(grid)) {
+        MappedBuffer oppositeSq;
+        if (band > 0) {
+            oppositeSq = MappedBuffer(pixelCount * sizeof(SquaredDistance));
+            const Span<SquaredDistance> distances(oppositeSq.data<SquaredDistance>(), pixelCount);
+            if (!coarseToFineDistances(mask, band, distances, cancel, report)) {
+                return failed();
+            }
+        } else {
+            oppositeSq = runs ? mappedSignedDistanceTransform2D(*runs, cancel, report)
+                              : mappedSignedDistanceTransform2D(mask, cancel, report);
+            if (oppositeSq.size() == 0) {
+                return failed();
+            }
+        }
+        const auto mergeBlock = [&](int start, int end) {
+            for (int y = start; y < end; ++y) {
+                const size_t rowOffset = static_cast<size_t>(y) * width;
+                signedDistanceRow(mask.row(y), oppositeSq.data<const SquaredDistance>() + rowOffset, width,
+                                  field.data() + rowOffset);
+            }
+        };
+        if (!runParallelBlocks(height, chooseBlockSize(height), cancel, mergeBlock, [](int) {})) {
+            return Status::Canceled;
+        }
+        return Status::Ok;
+    }
+
+    const MappedBuffer distOutsideSq = mappedDistanceTransform2D<double>(mask, false, cancel, report);
+    if (distOutsideSq.size() == 0) {
+        return failed();
+    }
+    const MappedBuffer distInsideSq = mappedDistanceTransform2D<double>(mask, true, cancel, report);
+    if (distInsideSq.size() == 0) {
+        return failed();
+    }
+    const auto mergeBlock = [&](int start, int end) {
+        double *row = ScratchArena::local().get<double>(ScratchArena::LineOutput, width);
+        for (int y = start; y < end; ++y) {
+            const size_t rowOffset = static_cast<size_t>(y) * width;
+            signedSqrtRow(distOutsideSq.data<const double>() + rowOffset, distInsideSq.data<const double>() + rowOffset,
+                          mask.row(y), width, row);
+            std::copy(row, row + width, field.data() + rowOffset);
+        }
+    };
+    if (!runParallelBlocks(height, chooseBlockSize(height), cancel, mergeBlock, [](int) {})) {
+        return Status::Canceled;
+    }
+    return Status::Ok;
+}
+
+// Signed distances of source sampled at width x height, in those pixels,
+// from the gray levels for antiAliased and from the thresholded mask
+// otherwise; band as in maskField(). Reports 3 * height + 2 * width units.
+Status sourceField(
+    const GrayImageView &source,
+    const SdfOptions &options,
+    int width,
+    int height,
+    int band,
+    std::vector<float> &field,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    if (options.antiAliased) {
+        const std::vector<float> coverage = resampleCoverage<float>(source, width, height, options.threshold, cancel);
+        if (coverage.empty()) {
+            return (cancel && cancel->load()) ? Status::Canceled : Status::TransformFailed;
+        }
+        report(height);
+        field.resize(coverage.size());
+        if (!antiAliasedSignedDistances<float>(coverage, width, height, field, cancel, report)) {
+            return (cancel && cancel->load()) ? Status::Canceled : Status::TransformFailed;
+        }
+        return Status::Ok;
+    }
+
+    SdfOptions grid = options;
+    grid.outWidth = width;
+    grid.outHeight = height;
+    BitMask insideMask;
+    const Status maskStatus = buildInsideMask(source, grid, SdfRect{0, 0, width, height}, insideMask, cancel, report);
+    if (maskStatus != Status::Ok) {
+        return maskStatus;
+    }
+    return maskField(insideMask, nullptr, band, field, cancel, report);
+}
+
+// Band for maskField() when options ask for a narrow band mode; 0 otherwise.
+int bandFor(const SdfOptions &options, int maxDistance)
+{
+    return (options.narrowBand || options.coarseToFine) && options.maxDistance > 0 ? maxDistance : 0;
+}
+
+// Field of the reduced grid of draftScale: the output size divided by
+// draftScale, rounded up. It is upsampled bilinearly to the output and
+// scaled by the mean of the two axis ratios. Grid pixels are aligned with
+// the output pixels they were sampled from: the first one of their block
+// for the nearest-neighbour mask, the block centre for area-averaged
+// coverage.
+class DraftField
+{
+public:
+    explicit DraftField(const SdfOptions &options)
+        : outWidth(options.outWidth)
+        , gridWidth((options.outWidth + options.draftScale - 1) / options.draftScale)
+        , gridHeight((options.outHeight + options.draftScale - 1) / options.draftScale)
+        , scale(0.5f * (static_cast<float>(options.outWidth) / gridWidth
+                        + static_cast<float>(options.outHeight) / gridHeight))
+        , edgeOffset(options.antiAliased ? 0.0f : 0.5f)
+    {
+        const double phase = options.antiAliased ? 0.5 : 0.0;
+        sampleAxis(gridWidth, options.outWidth, phase, columns, columnWeights);
+        sampleAxis(gridHeight, options.outHeight, phase, rows, rowWeights);
+        // The draft band covers maxDistance once scaled, plus the pixel the
+        // interpolation reaches past it.
+        band = options.maxDistance > 0 ? static_cast<int>(std::ceil(options.maxDistance / scale)) + 1 : 0;
+    }
+
+    int width() const { return gridWidth; }
+    int height() const { return gridHeight; }
+    int fieldBand() const { return band; }
+
+    // Takes the gridWidth x gridHeight signed distances. Hard-mask
+    // distances run between pixel centres, so the boundary sits half a
+    // pixel inside each side; that half pixel is taken off before scaling
+    // and added back at output size, or every distance would grow by
+    // (draftScale - 1) / 2.
+    void setField(std::vector<float> signedDistances)
+    {
+        field = std::move(signedDistances);
+        for (float &value : field) {
+            value -= value > 0.0f ? edgeOffset : -edgeOffset;
+        }
+    }
+
+    // Output row y of the upsampled field.
+    void upsampleRow(int y, float *row) const
+    {
+        const size_t y0 = static_cast<size_t>(rows[y]);
+        const size_t y1 = std::min(y0 + 1, static_cast<size_t>(gridHeight) - 1);
+        const float *top = field.data() + y0 * gridWidth;
+        const float *bottom = field.data() + y1 * gridWidth;
+        const float wy = rowWeights[y];
+        for (int x = 0; x < outWidth; ++x) {
+            const int x0 = columns[x];
+            const int x1 = std::min(x0 + 1, gridWidth - 1);
+            const float wx = columnWeights[x];
+            const float upper = top[x0] + wx * (top[x1] - top[x0]);
+            const float lower = bottom[x0] + wx * (bottom[x1] - bottom[x0]);
+            const float value = scale * (upper + wy * (lower - upper));
+            row[x] = value + (value > 0.0f ? edgeOffset : -edgeOffset);
+        }
+    }
+
+private:
+    // Grid cell and weight of the next cell for every output index, the
+    // output position i + phase mapped into the grid and clamped to its
+    // outer pixels.
+    static void sampleAxis(
+        int gridSize,
+        int outSize,
+        double phase,
+        std::vector<int> &cells,
+        std::vector<float> &weights)
+    {
+        cells.resize(static_cast<size_t>(outSize));
+        weights.resize(static_cast<size_t>(outSize));
+        for (int i = 0; i < outSize; ++i) {
+            const double position = std::clamp((i + phase) * gridSize / outSize - phase, 0.0, gridSize - 1.0);
+            const int cell = std::min(static_cast<int>(position), gridSize - 1);
+            cells[i] = cell;
+            weights[i] = static_cast<float>(position - cell);
+        }
+    }
+
+    int outWidth;
+    int gridWidth;
+    int gridHeight;
+    float scale;
+    float edgeOffset;
+    int band = 0;
+    std::vector<int> columns;
+    std::vector<float> columnWeights;
+    std::vector<int> rows;
+    std::vector<float> rowWeights;
+    std::vector<float> field;
+};
+
+// Draft path of generateSdf(). computeField(width, height, band, field,
+// report) fills the signed distances of the draft grid and reports
+// 3 * height + 2 * width units, forwarded as the same share of the output's
+// 3 * outHeight + 2 * outWidth; finalizeSdf() reports the rest.
+template <typename FieldFn>
+Status generateDraft(
+    const SdfOptions &options,
+    const FieldFn &computeField,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &report)
+{
+    DraftField draft(options);
+    const std::int64_t draftUnits = 3 * static_cast<std::int64_t>(draft.height()) + 2 * draft.width();
+    const int fieldUnits = 3 * options.outHeight + 2 * options.outWidth;
+    std::int64_t draftDone = 0;
+    int forwarded = 0;
+    const ProgressFn draftReport = [&](int delta) {
+        draftDone += delta;
+        const int units = static_cast<int>(std::min<std::int64_t>(fieldUnits, draftDone * fieldUnits / draftUnits));
+        if (units > forwarded) {
+            report(units - forwarded);
+            forwarded = units;
+        }
+    };
+
+    std::vector<float> field;
+    const Status fieldStatus =
+        computeField(draft.width(), draft.height(), bandFor(options, draft.fieldBand()), field, draftReport);
+    if (fieldStatus != Status::Ok) {
+        return fieldStatus;
+    }
+    if (forwarded < fieldUnits) {
+        report(fieldUnits - forwarded);
+    }
+    draft.setField(std::move(field));
+
+    const auto distanceRow = [&](int y, float *row) {
+        draft.upsampleRow(y, row);
+    };
+    return finalizeSdf<float>(options, distanceRow, output, cancel, report);
+}
+
+} // namespace
+
+Status generateSdf(
+    const GrayImageView &source,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (source.isNull()) {
+        return Status::InvalidInput;
+    }
+    const Status outputStatus = checkOutput(options, output);
+    if (outputStatus != Status::Ok) {
+        return outputStatus;
+    }
+
+    const ProgressFn report = [&progressFn](int delta) {
+        if (progressFn) {
+            progressFn(delta);
+        }
+    };
+
+    if (options.draftScale > 1) {
+        const auto computeField = [&](int width, int height, int band, std::vector<float> &field,
+                                      const ProgressFn &draftReport) {
+            return sourceField(source, options, width, height, band, field, cancel, draftReport);
+        };
+        return generateDraft(options, computeField, output, cancel, report);
+    }
+
+    if (options.antiAliased) {
+        if (resolvePrecision(options.precision, false, true) == Precision::Double) {
+            return generateAntiAliased<double>(source, options, output, cancel, report);
+        }
+        return generateAntiAliased<float>(source, options, output, cancel, report);
+    }
+
+    BitMask insideMask;
+    const SdfRect whole{0, 0, options.outWidth, options.outHeight};
+    const Status maskStatus = buildInsideMask(source, options, whole, insideMask, cancel, report);
+    if (maskStatus != Status::Ok) {
+        return maskStatus;
+    }
+
+    return generateFromMask(insideMask, nullptr, options, output, cancel, report);
+}
+
+Status generateSdf(
+    const RunMask &mask,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (mask.isNull() || options.antiAliased) {
+        return Status::InvalidInput;
+    }
+    const Status outputStatus = checkOutput(options, output);
+    if (outputStatus != Status::Ok) {
+        return outputStatus;
+    }
+
+    const ProgressFn report = [&progressFn](int delta) {
+        if (progressFn) {
+            progressFn(delta);
+        }
+    };
+
+    // The runs at the requested size, resampled on their toggles unless the
+    // mask already has it.
+    RunMask resampled;
+    const auto runsAt = [&](int width, int height) -> const RunMask & {
+        if (mask.width() == width && mask.height() == height) {
+            return mask;
+        }
+        resampled = resampleRunMask(mask, width, height);
+        return resampled;
+    };
+
+    if (options.draftScale > 1) {
+        const auto computeField = [&](int width, int height, int band, std::vector<float> &field,
+                                      const ProgressFn &draftReport) {
+            const RunMask &runs = runsAt(width, height);
+            BitMask insideMask;
+            const Status packStatus = packRunMask(runs, insideMask, cancel, draftReport);
+            if (packStatus != Status::Ok) {
+                return packStatus;
+            }
+            return maskField(insideMask, &runs, band, field, cancel, draftReport);
+        };
+        return generateDraft(options, computeField, output, cancel, report);
+    }
+
+    // The packed copy is what the other engines and the finalize pass read.
+    const RunMask &runs = runsAt(options.outWidth, options.outHeight);
+    BitMask insideMask;
+    const Status packStatus = packRunMask(runs, insideMask, cancel, report);
+    if (packStatus != Status::Ok) {
+        return packStatus;
+    }
+    return generateFromMask(insideMask, &runs, options, output, cancel, report);
+}
+
+SdfRect affectedRect(const SdfOptions &options, const SdfRect &dirty)
+{
+    const SdfRect clipped = growRect(dirty, 0, options.outWidth, options.outHeight);
+    return growRect(clipped, options.maxDistance, options.outWidth, options.outHeight);
+}
+
+Status updateSdfRect(
+    const GrayImageView &source,
+    const SdfOptions &options,
+    const SdfRect &dirty,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (source.isNull()) {
+        return Status::InvalidInput;
+    }
+    const Status outputStatus = checkOutput(options, output);
+    if (outputStatus != Status::Ok) {
+        return outputStatus;
+    }
+    if (options.normalization != Normalization::FixedRange || options.maxDistance <= 0 || options.antiAliased
+        || options.draftScale > 1 || !integerDistancesFit(options)) {
+        return Status::InvalidInput;
+    }
+
+    const SdfRect region = affectedRect(options, dirty);
+    if (region.isEmpty()) {
+        return Status::Ok;
+    }
+    const ProgressFn report = [&progressFn](int delta) {
+        if (progressFn) {
+            progressFn(delta);
+        }
+    };
+
+    // The clamped distances of region only depend on the mask within
+    // maxDistance of it.
+    const int band = options.maxDistance;
+    const SdfRect window = growRect(region, band, options.outWidth, options.outHeight);
+    BitMask windowMask;
+    const ProgressFn ignore = [](int) {};
+    const Status maskStatus = buildInsideMask(source, options, window, windowMask, cancel, ignore);
+    if (maskStatus != Status::Ok) {
+        return maskStatus;
+    }
+    report(region.height());
+
+    // Tiles of the region in parallel, each written straight into output.
+    constexpr int kTileSize = 128;
+    const int cols = (region.width() + kTileSize - 1) / kTileSize;
+    const int rows = (region.height() + kTileSize - 1) / kTileSize;
+    const float maxDistance = static_cast<float>(band);
+    const auto tileBlock = [&](int start, int end) {
+        ScratchArena &arena = ScratchArena::local();
+        for (int index = start; index < end; ++index) {
+            const int x0 = region.x0 + (index % cols) * kTileSize;
+            const int y0 = region.y0 + (index / cols) * kTileSize;
+            const int x1 = std::min(region.x1, x0 + kTileSize);
+            const int y1 = std::min(region.y1, y0 + kTileSize);
+            const int tileW = x1 - x0;
+            SquaredDistance *tileSq =
+                arena.get<SquaredDistance>(ScratchArena::TileDistances, static_cast<size_t>(tileW) * (y1 - y0));
+            narrowBandRect(windowMask, band, x0 - window.x0, y0 - window.y0, x1 - window.x0, y1 - window.y0, tileSq,
+                           static_cast<size_t>(tileW));
+            float *distances = arena.get<float>(ScratchArena::LineInput, tileW);
+            for (int y = y0; y < y1; ++y) {
+                quantizeFixedSquaredRow(tileSq + static_cast<size_t>(y - y0) * tileW, windowMask.row(y - window.y0),
+                                        x0 - window.x0, tileW, maxDistance, distances, output.row(y) + x0);
+            }
+        }
+    };
+
+    const int tileCount = cols * rows;
+    int tilesDone = 0;
+    int unitsReported = 0;
+    const auto reportTiles = [&](int delta) {
+        tilesDone += delta;
+        const int units = static_cast<int>((static_cast<long long>(region.height()) * tilesDone) / tileCount);
+        report(units - unitsReported);
+        unitsReported = std::max(unitsReported, units);
+    };
+    if (!runParallelBlocks(tileCount, 1, cancel, tileBlock, reportTiles)) {
+        return Status::Canceled;
+    }
+    return Status::Ok;
+}
+
+Status generateSdfFromContour(
+    const Contour &contour,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    if (contour.isNull()) {
+        return Status::InvalidInput;
+    }
+    const Status outputStatus = checkOutput(options, output);
+    if (outputStatus != Status::Ok) {
+        return outputStatus;
+    }
+
+    const ProgressFn report = [&progressFn](int delta) {
+        if (progressFn) {
+            progressFn(delta);
+        }
+    };
+
+    // Distances are measured in output pixels. The contour's own tree serves
+    // any uniform scale; other aspect ratios get a tree over the scaled
+    // segments.
+    const int outWidth = options.outWidth;
+    const double scaleX = static_cast<double>(outWidth) / contour.width();
+    const double scaleY = static_cast<double>(options.outHeight) / contour.height();
+    const bool uniform = std::abs(scaleX - scaleY) <= 1e-6 * std::max(scaleX, scaleY);
+    SegmentTree scaledTree;
+    if (!uniform) {
+        std::vector<ContourSegment> scaled = contour.segmentList();
+        for (ContourSegment &s : scaled) {
+            s = {static_cast<float>(s.x0 * scaleX), static_cast<float>(s.y0 * scaleY),
+                 static_cast<float>(s.x1 * scaleX), static_cast<float>(s.y1 * scaleY)};
+        }
+        scaledTree = SegmentTree(std::move(scaled));
+    }
+    const SegmentTree &tree = uniform ? contour.tree() : scaledTree;
+    const float treeScale = uniform ? static_cast<float>(scaleX) : 1.0f;
+    // generateSdf() measures from pixel centre to the nearest opposite
+    // centre, half a pixel past the boundary, so half a pixel is added to
+    // every distance to the contour. Pixels whose contour distance reaches
+    // reach are clamped anyway.
+    constexpr float kEdgeOffset = 0.5f;
+    constexpr int kContourSpan = 32;
+    const float reach = options.maxDistance > 0 ? std::max(0.0f, static_cast<float>(options.maxDistance) - kEdgeOffset)
+                                : std::numeric_limits<float>::max();
+    const float treeReach = reach / treeScale;
+
+    const auto distanceRow = [&](int y, float *row) {
+        const float sy = static_cast<float>((y + 0.5) / scaleY);
+        float *xs = ScratchArena::local().get<float>(ScratchArena::LineInput, contour.maxCrossings(sy));
+        const int count = contour.crossings(sy, xs);
+        const float qy = uniform ? sy : y + 0.5f;
+        const auto queryX = [&](int x) {
+            return uniform ? static_cast<float>((x + 0.5) / scaleX) : x + 0.5f;
+        };
+        // Spans of kContourSpan pixels share one candidate list: every pixel
+        // is within halfSpan of the span centre, so its nearest segment is
+        // within the centre's distance plus halfSpan, and only leaves that
+        // close are searched. A span with none is out of reach and keeps
+        // the clamp. Neighbouring pixels mostly share their nearest
+        // segment, so each query starts from the previous answer.
+        SegmentTree::Candidate *leaves =
+            ScratchArena::local().get<SegmentTree::Candidate>(ScratchArena::ContourLeaves, tree.maxCandidates());
+        std::uint32_t hint = 0xFFFFFFFFu;
+        int k = 0;
+        for (int spanX = 0; spanX < outWidth; spanX += kContourSpan) {
+            const int spanEnd = std::min(outWidth, spanX + kContourSpan);
+            const float spanX0 = queryX(spanX);
+            const float spanX1 = queryX(spanEnd - 1);
+            const float halfSpan = 0.5f * (spanX1 - spanX0);
+            const float centreDistance = tree.nearest(spanX0 + halfSpan, qy, treeReach + halfSpan, &hint);
+            const float spanBound = std::min(treeReach, (centreDistance + halfSpan) * 1.001f + 1e-3f);
+            const size_t leafCount = tree.candidates(spanX0, qy, spanX1, qy, spanBound, leaves);
+            const Span<const SegmentTree::Candidate> spanLeaves(leaves, leafCount);
+            for (int x = spanX; x < spanEnd; ++x) {
+                const float sx = static_cast<float>((x + 0.5) / scaleX);
+                while (k < count && xs[k] < sx) {
+                    ++k;
+                }
+                const float contourDistance = leafCount > 0
+                    ? std::min(reach, tree.nearestAmong(spanLeaves, queryX(x), qy, treeReach, &hint) * treeScale)
+                    : reach;
+                const float dist = contourDistance + kEdgeOffset;
+                row[x] = (k & 1) ? dist : -dist;
+            }
+        }
+    };
+    return finalizeSdf<float>(options, distanceRow, output, cancel, report);
+}
+
+Status measureDraftError(
+    const GrayImageView &source,
+    const SdfOptions &options,
+    DraftError &error,
+    std::atomic_bool *cancel)
+{
+    error = DraftError();
+    if (source.isNull() || options.draftScale < 1) {
+        return Status::InvalidInput;
+    }
+    if (options.outWidth <= 0 || options.outHeight <= 0) {
+        return Status::InvalidOutputSize;
+    }
+
+    const ProgressFn ignore = [](int) {};
+    DraftField draft(options);
+    std::vector<float> draftDistances;
+    Status status = sourceField(source, options, draft.width(), draft.height(),
+                                bandFor(options, draft.fieldBand()), draftDistances, cancel, ignore);
+    if (status != Status::Ok) {
+        return status;
+    }
+    draft.setField(std::move(draftDistances));
+    std::vector<float> exact;
+    status = sourceField(source, options, options.outWidth, options.outHeight,
+                         bandFor(options, options.maxDistance), exact, cancel, ignore);
+    if (status != Status::Ok) {
+        return status;
+    }
+
+    const int outWidth = options.outWidth;
+    const float maxDistance = static_cast<float>(options.maxDistance);
+    double errorSum = 0.0;
+    std::mutex errorMutex;
+    const auto compareBlock = [&](int start, int end) {
+        float *row = ScratchArena::local().get<float>(ScratchArena::LineOutput, outWidth);
+        DraftError local;
+        double localSum = 0.0;
+        for (int y = start; y < end; ++y) {
+            draft.upsampleRow(y, row);
+            const float *reference = exact.data() + static_cast<size_t>(y) * outWidth;
+            for (int x = 0; x < outWidth; ++x) {
+                float value = row[x];
+                float expected = reference[x];
+                if (options.maxDistance > 0) {
+                    value = std::clamp(value, -maxDistance, maxDistance);
+                    expected = std::clamp(expected, -maxDistance, maxDistance);
+                }
+                const double difference = std::abs(static_cast<double>(value) - expected);
+                local.maxError = std::max(local.maxError, difference);
+                localSum += difference;
+                local.flippedPixels += (value > 0.0f) != (expected > 0.0f) ? 1 : 0;
+            }
+        }
+        std::lock_guard<std::mutex> lock(errorMutex);
+        error.maxError = std::max(error.maxError, local.maxError);
+        error.flippedPixels += local.flippedPixels;
+        errorSum += localSum;
+    };
+    if (!runParallelBlocks(options.outHeight, chooseBlockSize(options.outHeight), cancel, compareBlock, ignore)) {
+        error = DraftError();
+        return Status::Canceled;
+    }
+    error.meanError = errorSum / (static_cast<double>(outWidth) * options.outHeight);
+    return Status::Ok;
+}
+
+} // namespace sdf
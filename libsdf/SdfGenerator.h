@@ -0,0 +1,186 @@
+#ifndef SDF_SDFGENERATOR_H
+#define SDF_SDFGENERATOR_H
+
+#include "DistanceTransform.h"
+#include "ImageView.h"
+#include "Parallel.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sdf {
+
+class Contour;
+
+// Exact distance transform used for the thresholded mask.
+enum class Engine
+{
+    // Felzenszwalb-Huttenlocher lower envelope (distanceTransform2D), at the
+    // resolved precision.
+    Felzenszwalb,
+    // Meijster's linear-time transform; always exact integer distances.
+    Meijster,
+};
+
+// How signed distances map to output bytes.
+enum class Normalization
+{
+    // Stretch the image's own min..max distance over 0..255. Needs the whole
+    // field before the first byte is written and depends on image content.
+    MinMax,
+    // Fixed spread: 0.5 + d / (2 * maxDistance), the usual font SDF
+    // convention. Written in a single streaming pass, identical for any
+    // tiling of the image. Needs maxDistance > 0.
+    FixedRange,
+};
+
+// Sizes are int per side, as are progress units and parallel item counts:
+// progressUnits() must fit in int, which bounds each side to a few hundred
+// million pixels. Pixel counts and offsets are computed in 64 bits, so the
+// total pixel count may pass 2^31.
+struct SdfOptions
+{
+    int outWidth = 0;
+    int outHeight = 0;
+    int threshold = 127;
+    // Distances are clamped to [-maxDistance, maxDistance]; 0 disables clamping.
+    int maxDistance = 0;
+    Precision precision = Precision::Auto;
+    // Ignored by the narrowBand, coarseToFine and antiAliased modes.
+    Engine engine = Engine::Felzenszwalb;
+    Normalization normalization = Normalization::MinMax;
+    // Only transform tiles within maxDistance of the boundary and fill the
+    // rest with the clamp value. Same output, cost follows the boundary
+    // length instead of the image area. Needs maxDistance > 0.
+    bool narrowBand = false;
+    // narrowBand, with the tiles far from the boundary found on a coarse
+    // 32 x 32 cell level and the rest transformed over windows sized by
+    // their coarse distance instead of maxDistance. Same output; faster
+    // when maxDistance is large. Needs maxDistance > 0.
+    bool coarseToFine = false;
+    // Estimate sub-pixel edge positions from the gray levels around the
+    // threshold (Gustavson's EDTAA3) instead of thresholding to a hard mask.
+    // The source is area-averaged to the output size. Takes precedence over
+    // narrowBand and coarseToFine.
+    bool antiAliased = false;
+    // Draft mode for previews: 2 or 4 computes the field at the output size
+    // divided by draftScale (rounded up) and bilinearly upsamples the signed
+    // distances, scaled to output pixels. About draftScale^2 times less
+    // transform work; the error concentrates at corners and features
+    // thinner than draftScale, see measureDraftError(). Applies to every
+    // generateSdf() mode; engine and precision are ignored, hard masks use
+    // the exact engine on the draft grid. updateSdfRect() rejects it.
+    // 1 = off.
+    int draftScale = 1;
+};
+
+// Pixels [x0, x1) x [y0, y1).
+struct SdfRect
+{
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+
+    int width() const { return x1 - x0; }
+    int height() const { return y1 - y0; }
+    bool isEmpty() const { return x1 <= x0 || y1 <= y0; }
+};
+
+enum class Status
+{
+    Ok,
+    Canceled,
+    InvalidInput,
+    InvalidOutputSize,
+    TransformFailed,
+};
+
+// Total number of progress units generateSdf() reports for the given options.
+int progressUnits(const SdfOptions &options);
+
+// Thresholds the 8-bit grayscale source (pixels > threshold are inside),
+// resamples it to outWidth x outHeight and writes the normalized SDF into
+// output, which must be at least outWidth x outHeight. Inside pixels map to
+// dark values, outside pixels to bright ones.
+Status generateSdf(
+    const GrayImageView &source,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// generateSdf() from a run-length mask, e.g. one built row by row from a
+// decoder with RunMask::appendRow(): the mask is resampled to the output
+// size on its runs, and the exact engine's row pass reads the runs directly.
+// threshold is not used, and antiAliased, which needs gray levels, returns
+// InvalidInput. Reports progressUnits(options) units like generateSdf().
+Status generateSdf(
+    const RunMask &mask,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// Difference between the draftScale draft of an SDF and the full-resolution
+// field, in output pixels, after clamping to maxDistance.
+struct DraftError
+{
+    double maxError = 0.0;
+    double meanError = 0.0;
+    // Pixels the draft puts on the other side of the boundary.
+    std::int64_t flippedPixels = 0;
+};
+
+// Computes both the draft that generateSdf() writes for options and the
+// full-resolution field, and compares their signed distances. Costs more
+// than a full run; meant for picking the draft scale an asset tolerates.
+Status measureDraftError(
+    const GrayImageView &source,
+    const SdfOptions &options,
+    DraftError &error,
+    std::atomic_bool *cancel);
+
+// Output pixels whose distance can change when the mask changes inside
+// dirty: dirty grown by maxDistance, clipped to the output.
+SdfRect affectedRect(const SdfOptions &options, const SdfRect &dirty);
+
+// Incremental form of generateSdf() for edited sources. output holds the
+// result of an earlier run with the same options; after source changed only
+// inside dirty (in output pixels), this rewrites affectedRect(dirty) from
+// the mask within 2 * maxDistance of dirty and leaves the rest untouched.
+// The result equals a full generateSdf() run. Needs
+// Normalization::FixedRange, where every byte depends only on the mask
+// around it, and maxDistance > 0; other options return InvalidInput.
+// progressFn receives 2 * affectedRect(dirty).height() units.
+Status updateSdfRect(
+    const GrayImageView &source,
+    const SdfOptions &options,
+    const SdfRect &dirty,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+// SDF from a contour extracted once with Contour::extract(): exact distances,
+// in output pixels, from each output pixel centre to the sub-pixel boundary
+// plus half a pixel, matching generateSdf()'s centre-to-centre convention,
+// then clamped and normalized like generateSdf(). Extraction treats
+// everything past the image border as outside, so shapes touching the
+// border match generateSdf() of the image padded with outside pixels. Each
+// row span only searches the contour near it, and spans out of reach of
+// maxDistance are clamped without per-pixel queries. The raster is not read
+// again, so one contour serves any number of output sizes. Uses outWidth,
+// outHeight, maxDistance and normalization; the threshold was fixed at
+// extraction and the engine options do not apply. progressFn receives
+// 2 * outHeight units.
+Status generateSdfFromContour(
+    const Contour &contour,
+    const SdfOptions &options,
+    const OutputImageView &output,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+} // namespace sdf
+
+#endif // SDF_SDFGENERATOR_H
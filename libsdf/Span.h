@@ -0,0 +1,74 @@
+#ifndef SDF_SPAN_H
+#define SDF_SPAN_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace sdf {
+
+// Minimal C++17 stand-in for std::span: a non-owning pointer + length pair.
+template <typename T>
+class Span
+{
+public:
+    using element_type = T;
+    using value_type = std::remove_cv_t<T>;
+
+    constexpr Span() noexcept
+        : ptr(nullptr)
+        , count(0)
+    {
+    }
+
+    constexpr Span(T *data, std::size_t size) noexcept
+        : ptr(data)
+        , count(size)
+    {
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    constexpr Span(const Span<U> &other) noexcept
+        : ptr(other.data())
+        , count(other.size())
+    {
+    }
+
+    template <typename U, typename Alloc,
+              typename = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    Span(std::vector<U, Alloc> &vec) noexcept
+        : ptr(vec.data())
+        , count(vec.size())
+    {
+    }
+
+    template <typename U, typename Alloc,
+              typename = std::enable_if_t<std::is_convertible<const U (*)[], T (*)[]>::value>>
+    Span(const std::vector<U, Alloc> &vec) noexcept
+        : ptr(vec.data())
+        , count(vec.size())
+    {
+    }
+
+    constexpr T *data() const noexcept { return ptr; }
+    constexpr std::size_t size() const noexcept { return count; }
+    constexpr bool empty() const noexcept { return count == 0; }
+
+    constexpr T &operator[](std::size_t i) const noexcept { return ptr[i]; }
+
+    constexpr T *begin() const noexcept { return ptr; }
+    constexpr T *end() const noexcept { return ptr + count; }
+
+    constexpr Span subspan(std::size_t offset, std::size_t length) const noexcept
+    {
+        return Span(ptr + offset, length);
+    }
+
+private:
+    T *ptr;
+    std::size_t count;
+};
+
+} // namespace sdf
+
+#endif // SDF_SPAN_H
@@ -0,0 +1,108 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace sdf {
+
+namespace {
+thread_local bool insideWorker = false;
+
+int defaultThreadCount()
+{
+    unsigned int hw = std::thread::hardware_concurrency();
+    if (hw == 0) {
+        hw = 4;
+    }
+    return static_cast<int>(hw);
+}
+} // namespace
+
+ThreadPool::ThreadPool(int threadCount)
+{
+    threadCount = std::max(1, threadCount);
+    threads.reserve(static_cast<size_t>(threadCount));
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCv.notify_all();
+    for (auto &thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+ThreadPool &ThreadPool::shared()
+{
+    static ThreadPool pool(defaultThreadCount());
+    return pool;
+}
+
+bool ThreadPool::isWorkerThread()
+{
+    return insideWorker;
+}
+
+void ThreadPool::start(std::function<void(int)> batchTask, int batchParticipants)
+{
+    batchMutex.lock();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = std::move(batchTask);
+        participants = std::clamp(batchParticipants, 1, size());
+        active = participants;
+        ++generation;
+    }
+    wakeCv.notify_all();
+}
+
+void ThreadPool::wait()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCv.wait(lock, [this]() { return active == 0; });
+        task = nullptr;
+    }
+    batchMutex.unlock();
+}
+
+void ThreadPool::workerLoop(int index)
+{
+    insideWorker = true;
+    std::uint64_t seenGeneration = 0;
+    while (true) {
+        std::function<void(int)> *current = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCv.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+            if (index >= participants) {
+                continue;
+            }
+            current = &task;
+        }
+
+        (*current)(index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --active;
+            if (active == 0) {
+                doneCv.notify_all();
+            }
+        }
+    }
+}
+
+} // namespace sdf
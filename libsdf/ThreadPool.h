@@ -0,0 +1,56 @@
+#ifndef SDF_THREADPOOL_H
+#define SDF_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sdf {
+
+// Long-lived set of worker threads. Batches are started with start() and
+// must be completed with wait() by the same thread; batches from different
+// callers are serialized.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Pool shared by every transform in the process.
+    static ThreadPool &shared();
+
+    // True when called from one of any pool's worker threads.
+    static bool isWorkerThread();
+
+    int size() const { return static_cast<int>(threads.size()); }
+
+    // Runs task(workerIndex) on workers [0, participants).
+    void start(std::function<void(int)> task, int participants);
+    void wait();
+
+private:
+    void workerLoop(int index);
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wakeCv;
+    std::condition_variable doneCv;
+    std::function<void(int)> task;
+    std::uint64_t generation = 0;
+    int participants = 0;
+    int active = 0;
+    bool stopping = false;
+
+    // Held from start() until the matching wait().
+    std::mutex batchMutex;
+};
+
+} // namespace sdf
+
+#endif // SDF_THREADPOOL_H
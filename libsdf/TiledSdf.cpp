@@ -0,0 +1,127 @@
+#include "TiledSdf.h"
+
+#include "BitMask.h"
+#include "NarrowBand.h"
+#include "Quantize.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace sdf {
+
+namespace {
+
+constexpr int kMaxTileSize = 4096;
+// Keeps maxDistance * maxDistance within SquaredDistance.
+constexpr int kMaxTiledDistance = 65535;
+
+} // namespace
+
+int tiledProgressUnits(const TiledSdfOptions &options)
+{
+    return 2 * options.height;
+}
+
+Status generateSdfTiled(
+    const TiledSdfOptions &options,
+    const SourceRowFn &sourceRow,
+    const TileSinkFn &sink,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn)
+{
+    const int width = options.width;
+    const int height = options.height;
+    if (width <= 0 || height <= 0) {
+        return Status::InvalidOutputSize;
+    }
+    if (!sourceRow || !sink || options.tileSize <= 0 || options.maxDistance <= 0
+        || options.maxDistance > kMaxTiledDistance) {
+        return Status::InvalidInput;
+    }
+
+    const int tileSize = std::min(options.tileSize, kMaxTileSize);
+    const int halo = options.maxDistance;
+    const float maxDistance = static_cast<float>(options.maxDistance);
+    const int tilesAcross = (width + tileSize - 1) / tileSize;
+    const auto report = [&progressFn](int delta) {
+        if (progressFn && delta > 0) {
+            progressFn(delta);
+        }
+    };
+
+    std::vector<std::uint8_t> sourceLine(static_cast<size_t>(width));
+    std::mutex sinkMutex;
+    BitMask strip;
+    int stripY0 = 0;
+
+    for (int y0 = 0; y0 < height; y0 += tileSize) {
+        const int y1 = std::min(height, y0 + tileSize);
+        const int wy0 = std::max(0, y0 - halo);
+        const int wy1 = std::min(height, y1 + halo);
+
+        // Rows shared with the previous strip are carried over; only the new
+        // ones are read from the source.
+        BitMask window(width, wy1 - wy0);
+        const int readFrom = strip.isNull() ? wy0 : stripY0 + strip.height();
+        for (int y = wy0; y < readFrom; ++y) {
+            std::copy_n(strip.row(y - stripY0), window.wordsPerRow(), window.row(y - wy0));
+        }
+        for (int y = readFrom; y < wy1; ++y) {
+            if (cancel && cancel->load()) {
+                return Status::Canceled;
+            }
+            if (!sourceRow(y, sourceLine.data())) {
+                return Status::InvalidInput;
+            }
+            packThreshold(sourceLine.data(), width, 1, options.threshold, window.row(y - wy0));
+            report(1);
+        }
+        strip = std::move(window);
+        stripY0 = wy0;
+
+        const int tileH = y1 - y0;
+        const auto tileBlock = [&](int start, int end) {
+            ScratchArena &arena = ScratchArena::local();
+            for (int index = start; index < end; ++index) {
+                const int x0 = index * tileSize;
+                const int x1 = std::min(width, x0 + tileSize);
+                const int tileW = x1 - x0;
+                const size_t tilePixels = static_cast<size_t>(tileW) * tileH;
+                SquaredDistance *tileSq = arena.get<SquaredDistance>(ScratchArena::TileDistances, tilePixels);
+                narrowBandRect(strip, halo, x0, y0 - wy0, x1, y1 - wy0, tileSq, static_cast<size_t>(tileW));
+
+                float *distances = arena.get<float>(ScratchArena::LineInput, tileW);
+                std::uint8_t *codes = arena.get<std::uint8_t>(ScratchArena::TileCodes, tilePixels);
+                for (int y = 0; y < tileH; ++y) {
+                    quantizeFixedSquaredRow(tileSq + static_cast<size_t>(y) * tileW, strip.row(y0 + y - wy0), x0, tileW,
+                                            maxDistance, distances, codes + static_cast<size_t>(y) * tileW);
+                }
+
+                GrayImageView tile;
+                tile.data = codes;
+                tile.width = tileW;
+                tile.height = tileH;
+                tile.stride = tileW;
+                std::lock_guard<std::mutex> lock(sinkMutex);
+                sink(x0, y0, tile);
+            }
+        };
+
+        int tilesDone = 0;
+        int unitsReported = 0;
+        const auto reportTiles = [&](int delta) {
+            tilesDone += delta;
+            const int units = static_cast<int>((static_cast<long long>(tileH) * tilesDone) / tilesAcross);
+            report(units - unitsReported);
+            unitsReported = std::max(unitsReported, units);
+        };
+        if (!runParallelBlocks(tilesAcross, 1, cancel, tileBlock, reportTiles)) {
+            return Status::Canceled;
+        }
+    }
+    return Status::Ok;
+}
+
+} // namespace sdf
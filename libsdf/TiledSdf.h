@@ -0,0 +1,54 @@
+#ifndef SDF_TILEDSDF_H
+#define SDF_TILEDSDF_H
+
+#include "ImageView.h"
+#include "Parallel.h"
+#include "SdfGenerator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+namespace sdf {
+
+// Writes row y of the 8-bit grayscale source (width bytes) into row. Rows
+// are requested once each, in increasing order. Returning false aborts.
+using SourceRowFn = std::function<bool(int y, std::uint8_t *row)>;
+
+// Receives the finished SDF bytes of the tile whose top-left pixel is
+// (x0, y0). Calls are serialized but arrive in no particular order; tile is
+// only valid during the call.
+using TileSinkFn = std::function<void(int x0, int y0, const GrayImageView &tile)>;
+
+struct TiledSdfOptions
+{
+    int width = 0;
+    int height = 0;
+    int threshold = 127;
+    // Required: tiles read a halo of maxDistance rows and columns around
+    // them, so distances are exact up to the clamp.
+    int maxDistance = 0;
+    int tileSize = 512;
+};
+
+// Total number of progress units generateSdfTiled() reports.
+int tiledProgressUnits(const TiledSdfOptions &options);
+
+// Streaming SDF for images too large to hold whole. The source is read a
+// strip of tileSize rows (plus the halo above and below) at a time and
+// thresholded one bit per pixel; the tiles of a strip run across the thread
+// pool, each through the narrow-band window transform, and are quantized
+// with the fixed spread 0.5 + d / (2 * maxDistance) and handed to sink.
+// Peak memory is one packed strip plus per-thread tile scratch, independent
+// of the image height. The bytes equal generateSdf() with
+// Normalization::FixedRange at the source size.
+Status generateSdfTiled(
+    const TiledSdfOptions &options,
+    const SourceRowFn &sourceRow,
+    const TileSinkFn &sink,
+    std::atomic_bool *cancel,
+    const ProgressFn &progressFn);
+
+} // namespace sdf
+
+#endif // SDF_TILEDSDF_H